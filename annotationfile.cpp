@@ -0,0 +1,60 @@
+/* *************************************************************** */
+/* annotationfile.cpp                      */
+/* *************************************************************** */
+#include "annotationfile.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+QString annotationPathForImage(const QString &imagePath)
+{
+    return imagePath.left(imagePath.lastIndexOf('.')) + ".json";
+}
+
+bool readAnnotationFile(const QString &jsonPath, AnnotationFile *out, QString *errorString)
+{
+    QFile file(jsonPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        if (errorString) {
+            *errorString = parseError.errorString();
+        }
+        return false;
+    }
+
+    QJsonObject rootObj = doc.object();
+    out->imagePath = rootObj["imagePath"].toString();
+    out->imageSize = QSize();
+    if (rootObj.contains("imageWidth") && rootObj.contains("imageHeight")) {
+        out->imageSize = QSize(rootObj["imageWidth"].toInt(), rootObj["imageHeight"].toInt());
+    }
+
+    out->shapes.clear();
+    const QJsonArray shapesArray = rootObj["shapes"].toArray();
+    out->shapes.reserve(shapesArray.size());
+    for (const QJsonValue &value : shapesArray) {
+        QJsonObject shapeObj = value.toObject();
+        AnnotationShape shape;
+        shape.label = shapeObj["label"].toString();
+        shape.shapeType = shapeObj["shape_type"].toString();
+
+        const QJsonArray pointsArray = shapeObj["points"].toArray();
+        shape.points.reserve(pointsArray.size());
+        for (const QJsonValue &pointValue : pointsArray) {
+            QJsonArray pointArray = pointValue.toArray();
+            shape.points << QPointF(pointArray.at(0).toDouble(), pointArray.at(1).toDouble());
+        }
+        out->shapes.append(shape);
+    }
+    return true;
+}
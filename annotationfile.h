@@ -0,0 +1,34 @@
+/* *************************************************************** */
+/* annotationfile.h                        */
+/* *************************************************************** */
+#ifndef ANNOTATIONFILE_H
+#define ANNOTATIONFILE_H
+
+#include <QString>
+#include <QPolygonF>
+#include <QList>
+#include <QSize>
+
+// labelme 格式 sidecar 文件中的一个标注形状
+struct AnnotationShape
+{
+    QString label;
+    QString shapeType; // "polygon", "rectangle", ...
+    QPolygonF points;
+};
+
+// sidecar 文件的几何内容。不解码 imageData，可以在工作线程中使用。
+struct AnnotationFile
+{
+    QString imagePath;
+    QSize imageSize; // 文件中未记录时为无效尺寸
+    QList<AnnotationShape> shapes;
+};
+
+// 图片对应的 sidecar 路径：同名的 .json 文件
+QString annotationPathForImage(const QString& imagePath);
+
+// 读取 sidecar 文件。文件不存在或无法解析时返回 false，并在 errorString 中给出原因。
+bool readAnnotationFile(const QString& jsonPath, AnnotationFile* out, QString* errorString = nullptr);
+
+#endif // ANNOTATIONFILE_H
@@ -0,0 +1,103 @@
+/* *************************************************************** */
+/* scenepopulationbench.cpp                */
+/* *************************************************************** */
+// 对比逐个 addItem/removeItem 与 CanvasScene 批量加载/清空的耗时。
+// 用法: scene_population_bench [形状数量，默认50000]
+#include "canvasscene.h"
+#include "polygonitem.h"
+#include "rectangleitem.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QtMath>
+
+namespace {
+
+QList<QGraphicsItem*> makeItems(int count)
+{
+    QRandomGenerator rng(42);
+    QList<QGraphicsItem*> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QPointF origin(rng.bounded(8000.0), rng.bounded(6000.0));
+        if (i % 2 == 0) {
+            auto rectangleItem = new RectangleItem(QRectF(origin, QSizeF(20 + rng.bounded(80.0), 20 + rng.bounded(80.0))));
+            rectangleItem->setLabel("car");
+            rectangleItem->setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsMovable);
+            items.append(rectangleItem);
+        } else {
+            QPolygonF polygon;
+            qreal radius = 10 + rng.bounded(40.0);
+            for (int k = 0; k < 8; ++k) {
+                qreal angle = qDegreesToRadians(45.0 * k);
+                polygon << origin + QPointF(qCos(angle), qSin(angle)) * radius;
+            }
+            auto polygonItem = new PolygonItem(polygon);
+            polygonItem->setLabel("person");
+            polygonItem->setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemSendsGeometryChanges);
+            items.append(polygonItem);
+        }
+    }
+    return items;
+}
+
+// BSP索引是惰性构建的，做一次区域查询让构建成本计入加载时间
+void buildIndex(QGraphicsScene &scene)
+{
+    scene.items(QRectF(0, 0, 100, 100));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    const int count = argc > 1 ? QString(argv[1]).toInt() : 50000;
+    QTextStream out(stdout);
+    out << "shapes: " << count << "\n";
+
+    {
+        CanvasScene scene;
+        QList<QGraphicsItem*> items = makeItems(count);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (QGraphicsItem *item : items) {
+            scene.addItem(item);
+        }
+        buildIndex(scene);
+        qint64 loadMs = timer.elapsed();
+
+        timer.restart();
+        const QList<QGraphicsItem*> sceneItems = scene.items();
+        for (QGraphicsItem *item : sceneItems) {
+            scene.removeItem(item);
+            delete item;
+        }
+        qint64 clearMs = timer.elapsed();
+        out << "per-item  load: " << loadMs << " ms, clear: " << clearMs << " ms\n";
+    }
+
+    {
+        CanvasScene scene;
+        QList<QGraphicsItem*> items = makeItems(count);
+
+        QElapsedTimer timer;
+        timer.start();
+        scene.addItemsBulk(items);
+        buildIndex(scene);
+        qint64 loadMs = timer.elapsed();
+
+        timer.restart();
+        scene.clearAllItems();
+        qint64 clearMs = timer.elapsed();
+        out << "bulk      load: " << loadMs << " ms, clear: " << clearMs << " ms\n";
+    }
+    return 0;
+}
@@ -5,16 +5,93 @@
 #include "polygonitem.h"
 #include "rectangleitem.h"
 #include "mainwindow.h"
+#include "magicwand.h"
 #include <QGraphicsLineItem>
+#include <QGraphicsPixmapItem>
+#include <QGraphicsPathItem>
+#include <QGraphicsView>
 #include <QPen>
 #include <QMenu>
 #include <QKeyEvent>
+#include <QPainter>
+#include <QtMath>
+#include <QStyleOptionGraphicsItem>
+#include <QtConcurrent>
 
-CanvasScene::CanvasScene(QObject *parent) : QGraphicsScene(parent) {}
+namespace {
+
+const int TileSize = 256;            // tile 的像素尺寸
+const qreal LabelMargin = 64.0;      // 标签文字可能超出item包围盒的范围（场景单位）
+const int TileCacheCostKB = 256 * 1024;
+const int DraftImageSize = 2048;     // 草稿图片最长边
+const int TraceChunkSegments = 64;   // 每个描边预览item包含的线段数
+const qreal TraceMinDistance = 2.0;  // 描边抽稀的最小间距（屏幕像素）
+const qreal TraceTolerance = 1.5;    // 描边抽稀的容差（屏幕像素）
+
+// 背景图片在最下层，缓存图层在图片之上、所有标注之下
+const qreal ImageZ = -2.0;
+const qreal TileLayerZ = -1.0;
+
+// QGraphicsItem::data() 中建议标注使用的键
+const int SuggestionKey = 0;
+const int SuggestionPenKey = 1;      // 标记为建议之前的画笔
+
+bool isAnnotationItem(const QGraphicsItem *item)
+{
+    return dynamic_cast<const PolygonItem*>(item) || dynamic_cast<const RectangleItem*>(item);
+}
+
+} // namespace
+
+// 缓存图层：覆盖整张图片的item，绘制时贴上暴露区域内的tile。
+// 放在标注之下，选中、悬停和正在绘制的item仍然画在它上面。
+class AnnotationTileLayer : public QGraphicsItem
+{
+public:
+    AnnotationTileLayer()
+    {
+        setZValue(TileLayerZ);
+        setAcceptedMouseButtons(Qt::NoButton);
+        // 需要 exposedRect 才能只贴可见的tile
+        setFlag(ItemUsesExtendedStyleOption);
+    }
+
+    void setBounds(const QRectF &rect)
+    {
+        if (rect != bounds) {
+            prepareGeometryChange();
+            bounds = rect;
+        }
+    }
+
+    QRectF boundingRect() const override { return bounds; }
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override
+    {
+        Q_UNUSED(widget);
+        if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+            canvas->drawAnnotationTiles(painter, option->exposedRect);
+        }
+    }
+
+private:
+    QRectF bounds;
+};
+
+CanvasScene::CanvasScene(QObject *parent) : QGraphicsScene(parent)
+{
+    tileCache.setMaxCost(TileCacheCostKB);
+
+    wandGeneration = std::make_shared<std::atomic<int>>(0);
+    wandWatcher = new QFutureWatcher<QPolygonF>(this);
+    connect(wandWatcher, &QFutureWatcherBase::finished, this, &CanvasScene::handleMagicWandFinished);
+}
 
 void CanvasScene::setMode(Mode mode)
 {
     currentMode = mode;
+    discardTrace();
+    discardMagicWand();
     if (mode == NoMode) {
         if (tempPolygonItem) {
             removeItem(tempPolygonItem);
@@ -35,11 +112,706 @@ void CanvasScene::setMode(Mode mode)
     }
 }
 
+bool CanvasScene::isDrawing() const
+{
+    return currentItem || tempPolygonItem || !currentPolygon.isEmpty() || tracing || wandPreviewItem
+        || mouseGrabberItem();
+}
+
 void CanvasScene::setCurrentLabel(const QString &label)
 {
     currentLabel = label;
 }
 
+void CanvasScene::setImage(const QPixmap &pixmap)
+{
+    if (depthImageItem) {
+        removeItem(depthImageItem);
+        delete depthImageItem;
+        depthImageItem = nullptr;
+    }
+    if (!imageItem) {
+        imageItem = addPixmap(pixmap);
+        imageItem->setZValue(ImageZ);
+    } else {
+        imageItem->setPixmap(pixmap);
+    }
+    imageItem->setScale(1.0);
+    fullPixmap = pixmap;
+    analysisFuture = QFuture<QImage>();
+    analysisStarted = false;
+    draftPixmap = QPixmap();
+    if (qMax(pixmap.width(), pixmap.height()) > DraftImageSize) {
+        draftPixmap = pixmap.scaled(DraftImageSize, DraftImageSize, Qt::KeepAspectRatio, Qt::FastTransformation);
+    }
+    if (draftMode && !draftPixmap.isNull()) {
+        imageItem->setPixmap(draftPixmap);
+        imageItem->setScale(qreal(pixmap.width()) / draftPixmap.width());
+    }
+    updateTileLayer();
+}
+
+void CanvasScene::setImage(const QImage &image)
+{
+    if (!HighDepthImageItem::isHighDepth(image)) {
+        setImage(QPixmap::fromImage(image));
+        return;
+    }
+
+    if (imageItem) {
+        removeItem(imageItem);
+        delete imageItem;
+        imageItem = nullptr;
+    }
+    if (depthImageItem) {
+        removeItem(depthImageItem);
+        delete depthImageItem;
+    }
+    fullPixmap = QPixmap();
+    draftPixmap = QPixmap();
+    analysisFuture = QFuture<QImage>();
+    analysisStarted = false;
+
+    depthImageItem = new HighDepthImageItem(image);
+    depthImageItem->setZValue(ImageZ);
+    depthImageItem->setDraftMode(draftMode);
+    addItem(depthImageItem);
+    updateTileLayer();
+}
+
+void CanvasScene::setDisplayWindow(const DisplayWindow &window)
+{
+    if (!depthImageItem) {
+        return;
+    }
+    depthImageItem->setDisplayWindow(window);
+    // 分析用的 8 位副本与屏幕显示保持一致
+    analysisFuture = QFuture<QImage>();
+    analysisStarted = false;
+}
+
+DisplayWindow CanvasScene::displayWindow() const
+{
+    return depthImageItem ? depthImageItem->displayWindow() : DisplayWindow();
+}
+
+DisplayWindow CanvasScene::automaticDisplayWindow() const
+{
+    return depthImageItem ? depthImageItem->automaticWindow() : DisplayWindow();
+}
+
+void CanvasScene::setDraftMode(bool enabled)
+{
+    if (draftMode == enabled) {
+        return;
+    }
+    draftMode = enabled;
+    draftTileLevel = lastTileLevel;
+    if (depthImageItem) {
+        depthImageItem->setDraftMode(enabled);
+    }
+
+    if (imageItem && !draftPixmap.isNull()) {
+        // 用缩放后的副本代替原图，item 的场景尺寸保持不变
+        if (enabled) {
+            imageItem->setPixmap(draftPixmap);
+            imageItem->setScale(qreal(fullPixmap.width()) / draftPixmap.width());
+        } else {
+            imageItem->setPixmap(fullPixmap);
+            imageItem->setScale(1.0);
+        }
+    }
+    if (!enabled && cachedRendering) {
+        update();
+    }
+}
+
+QFuture<QImage> CanvasScene::analysisImageFuture()
+{
+    if (!analysisStarted) {
+        analysisStarted = true;
+        // 每张图片（高位深图片每个窗宽窗位）只转换一次，之后的调用都复用。
+        // 整图转换放在工作线程中，GUI 线程只取得隐式共享的快照。
+        if (depthImageItem) {
+            analysisFuture = QtConcurrent::run(depthImageItem->rgbConverter());
+        } else if (!fullPixmap.isNull()) {
+            const QImage image = fullPixmap.toImage();
+            analysisFuture = QtConcurrent::run([image]() {
+                return image.convertToFormat(QImage::Format_RGB32);
+            });
+        } else {
+            analysisFuture = QtConcurrent::run([]() { return QImage(); });
+        }
+    }
+    return analysisFuture;
+}
+
+QImage CanvasScene::analysisImage()
+{
+    return analysisImageFuture().result();
+}
+
+void CanvasScene::addItemsBulk(const QList<QGraphicsItem*> &items)
+{
+    if (items.isEmpty()) {
+        return;
+    }
+
+    // 不用 items().size()：它会生成并排序全部item的列表，正是批量添加要避免的开销
+    bulkItemCount += items.size();
+    const int itemCount = bulkItemCount;
+    setItemIndexMethod(NoIndex);
+    for (QGraphicsItem *item : items) {
+        addItem(item);
+    }
+
+    // BSP树交替按x/y切分，叶子数为 2^depth；让每个叶子平均约16个item。
+    // Qt 自动选择的深度上限较低，几万个形状时每个叶子会积压大量item。
+    const int depth = qBound(4, int(std::ceil(std::log2(qMax(1, itemCount / 16)))), 18);
+
+    // 索引在下一次查询时才构建，因此切换回BSP后再设置深度只会触发一次构建
+    setItemIndexMethod(BspTreeIndex);
+    setBspTreeDepth(depth);
+}
+
+void CanvasScene::clearAllItems()
+{
+    // clear() 会删除这些临时item，先丢掉指向它们的指针
+    tempPolygonItem = nullptr;
+    rubberBandLine = nullptr;
+    currentItem = nullptr;
+    hoveredItem = nullptr;
+    imageItem = nullptr;
+    depthImageItem = nullptr;
+    tileLayer = nullptr;
+    traceChunks.clear();
+    traceTail = nullptr;
+    tracing = false;
+    editTarget = nullptr;
+    ++*wandGeneration;
+    wandPreviewItem = nullptr;
+    analysisFuture = QFuture<QImage>();
+    analysisStarted = false;
+    fullPixmap = QPixmap();
+    draftPixmap = QPixmap();
+    tileCache.clear();
+    bulkItemCount = 0;
+    currentPolygon.clear();
+    clearHighlights();
+
+    // clear() 先整体清空索引再删除item，避免逐个 removeItem 时反复更新BSP树
+    clear();
+    updateTileLayer();
+}
+
+void CanvasScene::setHighlights(const QList<QPainterPath> &paths)
+{
+    update(highlightBounds);
+    highlightPaths = paths;
+    highlightBounds = QRectF();
+    for (const QPainterPath &path : highlightPaths) {
+        highlightBounds |= path.boundingRect();
+    }
+    if (!highlightPaths.isEmpty()) {
+        // 高亮使用固定像素宽度的画笔，留出余量
+        highlightBounds.adjust(-10, -10, 10, 10);
+        update(highlightBounds);
+    }
+}
+
+void CanvasScene::clearHighlights()
+{
+    setHighlights({});
+}
+
+bool CanvasScene::isSuggestion(const QGraphicsItem *item)
+{
+    return item->data(SuggestionKey).toBool();
+}
+
+void CanvasScene::addSuggestions(const QList<QGraphicsItem*> &items)
+{
+    for (QGraphicsItem *item : items) {
+        if (auto shapeItem = dynamic_cast<QAbstractGraphicsShapeItem*>(item)) {
+            QPen pen = shapeItem->pen();
+            shapeItem->setData(SuggestionPenKey, QVariant::fromValue(pen));
+            pen.setStyle(Qt::DashLine);
+            shapeItem->setPen(pen);
+        }
+        item->setData(SuggestionKey, true);
+    }
+    addItemsBulk(items);
+}
+
+void CanvasScene::acceptSuggestions(const QList<QGraphicsItem*> &items)
+{
+    for (QGraphicsItem *item : items) {
+        if (!isSuggestion(item)) {
+            continue;
+        }
+        if (auto shapeItem = dynamic_cast<QAbstractGraphicsShapeItem*>(item)) {
+            shapeItem->setPen(shapeItem->data(SuggestionPenKey).value<QPen>());
+        }
+        item->setData(SuggestionKey, QVariant());
+        item->setData(SuggestionPenKey, QVariant());
+        // 画笔变化不会触发 itemChange，手动让缓存图层重画
+        annotationChanged(item);
+    }
+}
+
+void CanvasScene::rejectSuggestions(const QList<QGraphicsItem*> &items)
+{
+    for (QGraphicsItem *item : items) {
+        if (isSuggestion(item)) {
+            removeItem(item);
+            delete item;
+        }
+    }
+}
+
+QList<QGraphicsItem*> CanvasScene::suggestionItems() const
+{
+    QList<QGraphicsItem*> result;
+    for (QGraphicsItem *item : items(Qt::AscendingOrder)) {
+        if (isSuggestion(item)) {
+            result.append(item);
+        }
+    }
+    return result;
+}
+
+void CanvasScene::setCachedRendering(bool enabled)
+{
+    if (cachedRendering == enabled) {
+        return;
+    }
+    cachedRendering = enabled;
+    tileCache.clear();
+    updateTileLayer();
+    update();
+}
+
+void CanvasScene::updateTileLayer()
+{
+    if (!cachedRendering) {
+        if (tileLayer) {
+            removeItem(tileLayer);
+            delete tileLayer;
+            tileLayer = nullptr;
+        }
+        return;
+    }
+    if (!tileLayer) {
+        tileLayer = new AnnotationTileLayer();
+        addItem(tileLayer);
+    }
+    // 标签文字可能伸出图片边缘
+    QRectF bounds;
+    if (depthImageItem) {
+        bounds = depthImageItem->boundingRect();
+    } else if (!fullPixmap.isNull()) {
+        bounds = QRectF(fullPixmap.rect());
+    }
+    tileLayer->setBounds(bounds.isEmpty() ? QRectF() : bounds.adjusted(-LabelMargin, -LabelMargin, LabelMargin, LabelMargin));
+}
+
+bool CanvasScene::isCachedAnnotation(const QGraphicsItem *item) const
+{
+    // 正在绘制中的item还没有设置 ItemIsSelectable，始终实时绘制
+    return cachedRendering
+        && (item->flags() & QGraphicsItem::ItemIsSelectable)
+        && !item->isSelected();
+}
+
+bool CanvasScene::isDrawnFromCache(const QGraphicsItem *item) const
+{
+    return !renderingCache && item != hoveredItem && isCachedAnnotation(item);
+}
+
+void CanvasScene::annotationChanged(QGraphicsItem *item, bool geometryOnly)
+{
+    if (geometryOnly) {
+        emit annotationEdited();
+    }
+    if (!cachedRendering) {
+        return;
+    }
+    if (geometryOnly && !isCachedAnnotation(item)) {
+        return;
+    }
+    invalidateTiles(item->sceneBoundingRect());
+}
+
+void CanvasScene::notifyAnnotationEdited()
+{
+    emit annotationEdited();
+}
+
+void CanvasScene::annotationRemoved(QGraphicsItem *item)
+{
+    if (hoveredItem == item) {
+        hoveredItem = nullptr;
+    }
+    annotationChanged(item);
+}
+
+void CanvasScene::setHoveredAnnotation(QGraphicsItem *item)
+{
+    if (hoveredItem == item) {
+        return;
+    }
+    // 悬停的标注仍留在tile中，只是在缓存图层之上再实时绘制一遍，因此只需重绘，不必重新光栅化
+    QGraphicsItem *previous = hoveredItem;
+    hoveredItem = item;
+    if (previous) {
+        update(previous->sceneBoundingRect().adjusted(-LabelMargin, -LabelMargin, LabelMargin, LabelMargin));
+    }
+    if (item) {
+        update(item->sceneBoundingRect().adjusted(-LabelMargin, -LabelMargin, LabelMargin, LabelMargin));
+    }
+}
+
+QRectF CanvasScene::tileSceneRect(const AnnotationTileKey &key) const
+{
+    const qreal tileSceneSize = TileSize / std::pow(2.0, key.level / 2.0);
+    return QRectF(key.x * tileSceneSize, key.y * tileSceneSize, tileSceneSize, tileSceneSize);
+}
+
+void CanvasScene::invalidateTiles(const QRectF &sceneRect)
+{
+    if (tileCache.isEmpty()) {
+        return;
+    }
+    const QRectF dirty = sceneRect.adjusted(-LabelMargin, -LabelMargin, LabelMargin, LabelMargin);
+    const QList<AnnotationTileKey> keys = tileCache.keys();
+    for (const AnnotationTileKey &key : keys) {
+        if (tileSceneRect(key).intersects(dirty)) {
+            tileCache.remove(key);
+        }
+    }
+    update(dirty);
+}
+
+QPixmap CanvasScene::renderTile(const AnnotationTileKey &key)
+{
+    const QRectF tileRect = tileSceneRect(key);
+    QPixmap tile(TileSize, TileSize);
+    tile.fill(Qt::transparent);
+
+    QPainter painter(&tile);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.scale(TileSize / tileRect.width(), TileSize / tileRect.height());
+    painter.translate(-tileRect.topLeft());
+
+    // 标签文字画在包围盒左上角附近，可能伸出包围盒，因此扩大查询范围
+    const QRectF queryRect = tileRect.adjusted(-LabelMargin, -LabelMargin, LabelMargin, LabelMargin);
+    const QList<QGraphicsItem*> candidates = items(queryRect, Qt::IntersectsItemBoundingRect, Qt::AscendingOrder);
+
+    renderingCache = true;
+    QStyleOptionGraphicsItem option;
+    for (QGraphicsItem *item : candidates) {
+        if (!item->isVisible() || !isAnnotationItem(item) || !isCachedAnnotation(item)) {
+            continue;
+        }
+        option.exposedRect = item->boundingRect();
+        painter.save();
+        painter.setTransform(item->sceneTransform(), true);
+        item->paint(&painter, &option, nullptr);
+        painter.restore();
+    }
+    renderingCache = false;
+    return tile;
+}
+
+void CanvasScene::drawAnnotationTiles(QPainter *painter, const QRectF &rect)
+{
+    if (!cachedRendering) {
+        return;
+    }
+
+    // 当前缩放按半个八度量化，同一级别内的缩放复用同一组tile
+    const QTransform &transform = painter->worldTransform();
+    const qreal scale = QLineF(transform.map(QPointF(0, 0)), transform.map(QPointF(1, 0))).length();
+    // 草稿模式下沿用进入时的级别，缩放动画的每一帧不必重新光栅化整层；
+    // 缩放变化超过两个八度时旧tile的清晰度或数量都不合适，改用当前级别
+    int level = qRound(std::log2(qMax(scale, 1e-6)) * 2.0);
+    if (draftMode && qAbs(level - draftTileLevel) <= 4) {
+        level = draftTileLevel;
+    }
+    lastTileLevel = level;
+    const qreal tileSceneSize = TileSize / std::pow(2.0, level / 2.0);
+
+    const int left = int(std::floor(rect.left() / tileSceneSize));
+    const int right = int(std::floor(rect.right() / tileSceneSize));
+    const int top = int(std::floor(rect.top() / tileSceneSize));
+    const int bottom = int(std::floor(rect.bottom() / tileSceneSize));
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            AnnotationTileKey key{level, x, y};
+            QPixmap tile;
+            if (QPixmap *cached = tileCache.object(key)) {
+                tile = *cached;
+            } else {
+                tile = renderTile(key);
+                tileCache.insert(key, new QPixmap(tile), TileSize * TileSize * 4 / 1024);
+            }
+            painter->drawPixmap(tileSceneRect(key), tile, QRectF(tile.rect()));
+        }
+    }
+    painter->restore();
+}
+
+void CanvasScene::drawForeground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsScene::drawForeground(painter, rect);
+
+    if (highlightPaths.isEmpty() || !rect.intersects(highlightBounds)) {
+        return;
+    }
+
+    QPen pen(Qt::magenta, 3, Qt::DashLine);
+    pen.setCosmetic(true);
+    painter->save();
+    painter->setPen(pen);
+    painter->setBrush(Qt::NoBrush);
+    for (const QPainterPath &path : highlightPaths) {
+        painter->drawPath(path);
+    }
+    painter->restore();
+}
+
+void CanvasScene::beginTrace(const QPointF &point)
+{
+    discardTrace();
+    tracing = true;
+    // 抽稀阈值按屏幕像素给出，换算成场景单位，放大或缩小时手感一致
+    qreal scale = 1.0;
+    if (!views().isEmpty()) {
+        const QTransform transform = views().first()->transform();
+        scale = qSqrt(transform.m11() * transform.m11() + transform.m12() * transform.m12());
+    }
+    scale = qMax(scale, 1e-6);
+    traceDecimator.setThresholds(TraceMinDistance / scale, TraceTolerance / scale);
+    traceDecimator.reset();
+    traceDecimator.addPoint(point);
+    tracedPointCount = 1;
+
+    traceTail = new QGraphicsPathItem();
+    traceTail->setPen(QPen(Qt::blue, 2, Qt::DashLine));
+    addItem(traceTail);
+}
+
+void CanvasScene::extendTrace(const QPointF &point)
+{
+    traceDecimator.addPoint(point);
+
+    // 只把新确定的点追加到最后一个预览段，段满后新建一个，避免每次重建整条路径
+    const QPolygonF &committed = traceDecimator.committedPoints();
+    for (; tracedPointCount < committed.size(); ++tracedPointCount) {
+        QGraphicsPathItem *chunk = traceChunks.isEmpty() ? nullptr : traceChunks.last();
+        if (!chunk || chunk->path().elementCount() > TraceChunkSegments) {
+            chunk = new QGraphicsPathItem();
+            chunk->setPen(QPen(Qt::blue, 2));
+            QPainterPath path;
+            path.moveTo(committed[tracedPointCount - 1]);
+            chunk->setPath(path);
+            addItem(chunk);
+            traceChunks.append(chunk);
+        }
+        QPainterPath path = chunk->path();
+        path.lineTo(committed[tracedPointCount]);
+        chunk->setPath(path);
+    }
+
+    QPainterPath tail;
+    tail.moveTo(committed.last());
+    for (const QPointF &pending : traceDecimator.pendingPoints()) {
+        tail.lineTo(pending);
+    }
+    tail.lineTo(point);
+    traceTail->setPath(tail);
+}
+
+QPolygonF CanvasScene::finishTrace()
+{
+    traceDecimator.finish();
+    QPolygonF stroke = traceDecimator.committedPoints();
+    discardTrace();
+    return stroke;
+}
+
+void CanvasScene::discardTrace()
+{
+    for (QGraphicsPathItem *chunk : traceChunks) {
+        removeItem(chunk);
+        delete chunk;
+    }
+    traceChunks.clear();
+    if (traceTail) {
+        removeItem(traceTail);
+        delete traceTail;
+        traceTail = nullptr;
+    }
+    tracing = false;
+    tracedPointCount = 0;
+}
+
+void CanvasScene::applyBoundaryEdit(PolygonItem *item, const QPolygonF &sceneStroke)
+{
+    const QPolygonF polygon = item->polygon();
+    const int n = polygon.size();
+    if (n < 3) {
+        return;
+    }
+    const QPolygonF stroke = item->mapFromScene(sceneStroke);
+
+    auto nearestVertex = [&polygon](const QPointF &point) {
+        int best = 0;
+        qreal bestDistance = QLineF(point, polygon[0]).length();
+        for (int i = 1; i < polygon.size(); ++i) {
+            qreal distance = QLineF(point, polygon[i]).length();
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = i;
+            }
+        }
+        return best;
+    };
+    // 沿顶点顺序从 from 走到 to（包含两端）
+    auto forwardArc = [&polygon, n](int from, int to) {
+        QPolygonF arc;
+        for (int i = from;; i = (i + 1) % n) {
+            arc << polygon[i];
+            if (i == to) {
+                break;
+            }
+        }
+        return arc;
+    };
+    auto arcLength = [](const QPolygonF &arc) {
+        qreal length = 0.0;
+        for (int i = 1; i < arc.size(); ++i) {
+            length += QLineF(arc[i - 1], arc[i]).length();
+        }
+        return length;
+    };
+
+    const int startIndex = nearestVertex(stroke.first());
+    const int endIndex = nearestVertex(stroke.last());
+
+    QPolygonF result;
+    if (startIndex == endIndex) {
+        // 描边起止于同一个顶点附近：把描边插入到该顶点之后
+        result = forwardArc((startIndex + 1) % n, startIndex);
+        result += stroke;
+    } else {
+        // 描边替换两个顶点之间较短的那段边界，保留较长的一段
+        QPolygonF keepIfReplacingForward = forwardArc(endIndex, startIndex);
+        QPolygonF keepIfReplacingBackward = forwardArc(startIndex, endIndex);
+        if (arcLength(keepIfReplacingForward) >= arcLength(keepIfReplacingBackward)) {
+            result = keepIfReplacingForward;
+            result += stroke;
+        } else {
+            result = keepIfReplacingBackward;
+            for (int i = stroke.size() - 1; i >= 0; --i) {
+                result << stroke[i];
+            }
+        }
+    }
+
+    if (result.size() > 2) {
+        // 形状缩小时旧的填充在新包围盒之外，新旧两个范围的tile都要失效
+        const QRectF oldBounds = item->sceneBoundingRect();
+        item->setPolygon(result);
+        if (cachedRendering) {
+            invalidateTiles(oldBounds | item->sceneBoundingRect());
+        }
+        emit annotationEdited();
+    }
+}
+
+void CanvasScene::setMagicWandTolerance(int tolerance)
+{
+    tolerance = qBound(0, tolerance, 255);
+    if (tolerance == wandTolerance) {
+        return;
+    }
+    wandTolerance = tolerance;
+    emit magicWandToleranceChanged(wandTolerance);
+    // 调整容差后在原来的种子点重新分割
+    if (currentMode == MagicWand && wandPreviewItem) {
+        runMagicWand(wandSeed);
+    }
+}
+
+void CanvasScene::runMagicWand(const QPointF &scenePoint)
+{
+    if (!imageItem && !depthImageItem) {
+        return;
+    }
+    wandSeed = scenePoint;
+
+    // 递增代数使仍在运行的旧计算在下一次检查时放弃
+    const int generation = ++*wandGeneration;
+    wandJobGeneration = generation;
+    std::shared_ptr<std::atomic<int>> currentGeneration = wandGeneration;
+    // 转换还没完成时由工作线程等待，点击不阻塞界面
+    const QFuture<QImage> imageFuture = analysisImageFuture();
+    const QPoint seed(int(std::floor(scenePoint.x())), int(std::floor(scenePoint.y())));
+    const int tolerance = wandTolerance;
+
+    wandWatcher->setFuture(QtConcurrent::run([imageFuture, seed, tolerance, currentGeneration, generation]() {
+        return MagicWand::segment(imageFuture.result(), seed, tolerance, [&currentGeneration, generation]() {
+            return currentGeneration->load() != generation;
+        });
+    }));
+}
+
+void CanvasScene::handleMagicWandFinished()
+{
+    if (wandJobGeneration != wandGeneration->load() || currentMode != MagicWand) {
+        return;
+    }
+    QPolygonF polygon = wandWatcher->result();
+    if (polygon.size() < 3) {
+        return;
+    }
+
+    if (!wandPreviewItem) {
+        wandPreviewItem = addPolygon(polygon, QPen(Qt::yellow, 2, Qt::DashLine), QColor(255, 255, 0, 60));
+    } else {
+        wandPreviewItem->setPolygon(polygon);
+    }
+}
+
+void CanvasScene::acceptMagicWand()
+{
+    if (!wandPreviewItem) {
+        return;
+    }
+    QPolygonF polygon = wandPreviewItem->polygon();
+    discardMagicWand();
+
+    auto finalPolygonItem = new PolygonItem(polygon);
+    finalPolygonItem->setLabel(currentLabel);
+    finalPolygonItem->setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemSendsGeometryChanges);
+    addItem(finalPolygonItem);
+    emit polygonFinished(finalPolygonItem);
+}
+
+void CanvasScene::discardMagicWand()
+{
+    ++*wandGeneration;
+    if (wandPreviewItem) {
+        removeItem(wandPreviewItem);
+        delete wandPreviewItem;
+        wandPreviewItem = nullptr;
+    }
+}
+
 void CanvasScene::mousePressEvent(QGraphicsSceneMouseEvent *event)
 {
     if (event->button() != Qt::LeftButton) {
@@ -65,6 +837,31 @@ void CanvasScene::mousePressEvent(QGraphicsSceneMouseEvent *event)
         startPoint = event->scenePos();
         currentItem = new RectangleItem(QRectF(startPoint, startPoint));
         addItem(currentItem);
+    } else if (currentMode == FreehandPolygon) {
+        beginTrace(event->scenePos());
+        event->accept(); // 接收事件，否则视图会开始抓手平移
+    } else if (currentMode == MagicWand) {
+        runMagicWand(event->scenePos());
+        event->accept();
+    } else if (currentMode == EditPolygonBoundary) {
+        // 优先修整已选中的多边形，否则修整点击位置下的多边形
+        editTarget = nullptr;
+        for (QGraphicsItem *item : selectedItems()) {
+            if ((editTarget = dynamic_cast<PolygonItem*>(item))) {
+                break;
+            }
+        }
+        if (!editTarget) {
+            for (QGraphicsItem *item : items(event->scenePos())) {
+                if ((editTarget = dynamic_cast<PolygonItem*>(item))) {
+                    break;
+                }
+            }
+        }
+        if (editTarget) {
+            beginTrace(event->scenePos());
+        }
+        event->accept();
     } else {
         QGraphicsScene::mousePressEvent(event);
     }
@@ -78,6 +875,8 @@ void CanvasScene::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
         auto rectItem = static_cast<RectangleItem*>(currentItem);
         QRectF newRect(startPoint, event->scenePos());
         rectItem->setRect(newRect.normalized());
+    } else if (tracing) {
+        extendTrace(event->scenePos());
     } else {
         QGraphicsScene::mouseMoveEvent(event);
     }
@@ -93,9 +892,22 @@ void CanvasScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
     if (currentMode == DrawRectangle && currentItem) {
         auto rectItem = static_cast<RectangleItem*>(currentItem);
         rectItem->setLabel(currentLabel);
-        rectItem->setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsMovable);
+        rectItem->setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemSendsGeometryChanges);
         emit rectangleFinished(rectItem);
         currentItem = nullptr; // The item is now permanent
+    } else if (tracing) {
+        extendTrace(event->scenePos());
+        QPolygonF stroke = finishTrace();
+        if (currentMode == FreehandPolygon && stroke.size() > 2) {
+            auto finalPolygonItem = new PolygonItem(stroke);
+            finalPolygonItem->setLabel(currentLabel);
+            finalPolygonItem->setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemSendsGeometryChanges);
+            addItem(finalPolygonItem);
+            emit polygonFinished(finalPolygonItem);
+        } else if (currentMode == EditPolygonBoundary && editTarget && stroke.size() > 1) {
+            applyBoundaryEdit(editTarget, stroke);
+        }
+        editTarget = nullptr;
     } else {
         QGraphicsScene::mouseReleaseEvent(event);
     }
@@ -128,6 +940,26 @@ void CanvasScene::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
 
 void CanvasScene::keyPressEvent(QKeyEvent *event)
 {
+    if (currentMode == MagicWand) {
+        switch (event->key()) {
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+            acceptMagicWand();
+            return;
+        case Qt::Key_Escape:
+            discardMagicWand();
+            return;
+        case Qt::Key_BracketLeft:
+            setMagicWandTolerance(wandTolerance - 8);
+            return;
+        case Qt::Key_BracketRight:
+            setMagicWandTolerance(wandTolerance + 8);
+            return;
+        default:
+            break;
+        }
+    }
+
     if (event->key() == Qt::Key_Escape) {
         if (currentMode == DrawRectangle && currentItem) {
             removeItem(currentItem);
@@ -137,6 +969,11 @@ void CanvasScene::keyPressEvent(QKeyEvent *event)
         } else if (currentMode == DrawPolygon) {
             // Handle polygon cancellation if needed
             setMode(NoMode);
+        } else if (tracing) {
+            // 放弃描了一半的边界，保持当前模式以便重新开始
+            discardTrace();
+            editTarget = nullptr;
+            return;
         }
     }
     QGraphicsScene::keyPressEvent(event);
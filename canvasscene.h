@@ -9,25 +9,121 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QPolygonF>
 #include <QMenu>
+#include <QPainterPath>
+#include <QCache>
+#include <QPixmap>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
+#include "pointdecimator.h"
+#include "highdepthimageitem.h"
 
 class PolygonItem;
 class RectangleItem;
 class QGraphicsLineItem;
+class QGraphicsPixmapItem;
+class QGraphicsPathItem;
+class AnnotationTileLayer;
+
+// 缓存图层中一个tile的位置：缩放级别（半个八度为一级）和tile坐标
+struct AnnotationTileKey
+{
+    int level;
+    int x;
+    int y;
+};
+
+inline bool operator==(const AnnotationTileKey &a, const AnnotationTileKey &b)
+{
+    return a.level == b.level && a.x == b.x && a.y == b.y;
+}
+
+inline size_t qHash(const AnnotationTileKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.level, key.x, key.y);
+}
 
 class CanvasScene : public QGraphicsScene
 {
     Q_OBJECT
 
 public:
-    enum Mode { NoMode, DrawPolygon, DrawRectangle };
+    // FreehandPolygon: 按住鼠标拖动描边；EditPolygonBoundary: 在选中的多边形上重新描一段边界；
+    // MagicWand: 单击按颜色容差分割区域，回车确认
+    enum Mode { NoMode, DrawPolygon, DrawRectangle, FreehandPolygon, EditPolygonBoundary, MagicWand };
     explicit CanvasScene(QObject *parent = nullptr);
 
     void setMode(Mode mode);
+    // 正在绘制、描边、拖动或有待确认的魔棒结果。此时场景持有指向标注item的临时指针，
+    // 不能从外部删除标注。
+    bool isDrawing() const;
     void setCurrentLabel(const QString& label);
 
+    // 设置背景图片。大图会额外生成一份低分辨率副本，供交互期间的草稿模式使用。
+    void setImage(const QPixmap& pixmap);
+    // 16 位等高位深图片保持原始位深显示，其余图片转换成 QPixmap
+    void setImage(const QImage& image);
+    bool hasHighDepthImage() const { return depthImageItem != nullptr; }
+    // 高位深图片的窗宽窗位，普通图片上调用无效
+    void setDisplayWindow(const DisplayWindow& window);
+    DisplayWindow displayWindow() const;
+    DisplayWindow automaticDisplayWindow() const;
+    // 草稿模式：视图正在缩放或平移。使用低分辨率图片，缓存图层保持在进入时的缩放级别。
+    void setDraftMode(bool enabled);
+    bool isDraftMode() const { return draftMode; }
+    // 当前图片的 RGB32 副本，第一次调用时在工作线程中转换，供魔棒和帧间跟踪等分析使用。
+    // analysisImage 等待转换完成；analysisImageFuture 不阻塞，可交给其他工作线程等待。
+    QImage analysisImage();
+    QFuture<QImage> analysisImageFuture();
+
+    // 批量添加item。期间关闭BSP索引，全部加入后按item数量设置树深度并只重建一次索引。
+    void addItemsBulk(const QList<QGraphicsItem*>& items);
+    // 删除场景中的全部item（包括图片和正在绘制的临时item），不逐个更新索引
+    void clearAllItems();
+
+    // 在所有item之上高亮显示一组轮廓（场景坐标），用于标出质检发现的问题形状
+    void setHighlights(const QList<QPainterPath>& paths);
+    void clearHighlights();
+
+    // 缓存渲染：未选中的标注按缩放级别光栅化到tile缓存中，由图片之上、标注之下的
+    // 缓存图层贴图；选中的标注作为普通item实时绘制，悬停的标注再实时叠加一遍。
+    void setCachedRendering(bool enabled);
+    bool isCachedRendering() const { return cachedRendering; }
+    // 该标注画在tile中
+    bool isCachedAnnotation(const QGraphicsItem* item) const;
+    // 该标注只由缓存图层绘制，item 的 paint 应跳过
+    bool isDrawnFromCache(const QGraphicsItem* item) const;
+    bool isRenderingCache() const { return renderingCache; }
+    // 由缓存图层item调用，贴上 rect（场景坐标）内的tile
+    void drawAnnotationTiles(QPainter* painter, const QRectF& rect);
+
+    // 由标注item调用，使其所在区域的tile失效。geometryOnly 表示仅位置变化，
+    // 实时绘制的item移动时不影响缓存。
+    void annotationChanged(QGraphicsItem* item, bool geometryOnly = false);
+    void annotationRemoved(QGraphicsItem* item);
+    void setHoveredAnnotation(QGraphicsItem* item);
+    // 由标注item调用：用户修改了已有标注的形状（拖动顶点等）
+    void notifyAnnotationEdited();
+
+    // 建议：自动生成、等待确认的标注。虚线显示，保存时跳过，接受后变为普通标注。
+    static bool isSuggestion(const QGraphicsItem* item);
+    void addSuggestions(const QList<QGraphicsItem*>& items);
+    void acceptSuggestions(const QList<QGraphicsItem*>& items);
+    void rejectSuggestions(const QList<QGraphicsItem*>& items);
+    QList<QGraphicsItem*> suggestionItems() const;
+
+    void setMagicWandTolerance(int tolerance);
+    int magicWandTolerance() const { return wandTolerance; }
+
 signals:
     void polygonFinished(PolygonItem* item);
     void rectangleFinished(RectangleItem* item);
+    void magicWandToleranceChanged(int tolerance);
+    // 已有标注被移动或改变了形状。新建、删除、改标签由 MainWindow 自己记录。
+    void annotationEdited();
+
+private slots:
+    void handleMagicWandFinished();
 
 protected:
     void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
@@ -36,6 +132,7 @@ protected:
     void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event) override;
     void contextMenuEvent(QGraphicsSceneContextMenuEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
+    void drawForeground(QPainter *painter, const QRectF &rect) override;
 
 private:
     Mode currentMode = NoMode;
@@ -46,6 +143,60 @@ private:
 
     QPointF startPoint;
     QGraphicsItem* currentItem = nullptr; // Generic pointer for the item being drawn
+
+    QList<QPainterPath> highlightPaths;
+    QRectF highlightBounds;
+
+    // 自由描边：已确定的点按段追加到若干个小的路径item中，未确定的尾部单独绘制，
+    // 每个鼠标事件只更新有限数量的点
+    void beginTrace(const QPointF& point);
+    void extendTrace(const QPointF& point);
+    QPolygonF finishTrace();
+    void discardTrace();
+    void applyBoundaryEdit(PolygonItem* item, const QPolygonF& stroke);
+
+    StreamingDecimator traceDecimator;
+    bool tracing = false;
+    int tracedPointCount = 0;
+    QList<QGraphicsPathItem*> traceChunks;
+    QGraphicsPathItem* traceTail = nullptr;
+    PolygonItem* editTarget = nullptr;
+
+    // 魔棒：分割在工作线程中进行，新的点击会让旧的计算提前结束
+    void runMagicWand(const QPointF& scenePoint);
+    void acceptMagicWand();
+    void discardMagicWand();
+
+    int wandTolerance = 32;
+    QPointF wandSeed;
+    QFutureWatcher<QPolygonF>* wandWatcher;
+    std::shared_ptr<std::atomic<int>> wandGeneration;
+    int wandJobGeneration = 0;
+    QGraphicsPolygonItem* wandPreviewItem = nullptr;
+
+    QRectF tileSceneRect(const AnnotationTileKey& key) const;
+    QPixmap renderTile(const AnnotationTileKey& key);
+    void invalidateTiles(const QRectF& sceneRect);
+    // 按当前图片大小创建或调整缓存图层，关闭缓存渲染时删除
+    void updateTileLayer();
+
+    QGraphicsPixmapItem* imageItem = nullptr;
+    HighDepthImageItem* depthImageItem = nullptr;
+    QPixmap fullPixmap;
+    QFuture<QImage> analysisFuture;
+    bool analysisStarted = false;
+    QPixmap draftPixmap;
+    bool draftMode = false;
+    int draftTileLevel = 0;
+    int lastTileLevel = 0;
+
+    bool cachedRendering = false;
+    bool renderingCache = false;
+    QGraphicsItem* hoveredItem = nullptr;
+    // 自上次 clearAllItems 以来批量添加的item数，用于估计BSP树深度（逐个添加、删除的少量item不计）
+    int bulkItemCount = 0;
+    AnnotationTileLayer* tileLayer = nullptr;
+    QCache<AnnotationTileKey, QPixmap> tileCache;
 };
 
 #endif // CANVASCENE_H
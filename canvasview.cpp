@@ -2,27 +2,143 @@
 /* canvasview.cpp                          */
 /* *************************************************************** */
 #include "canvasview.h"
+#include "canvasscene.h"
 #include <QWheelEvent>
+#include <QTimer>
+#include <QtMath>
+
+namespace {
+
+const qreal ZoomStep = 1.15;          // 每个滚轮刻度的缩放倍数
+const int FrameBudgetMs = 16;         // 缩放动画每帧的目标时间
+const qreal ZoomEasing = 0.35;        // 每帧应用剩余缩放量的比例
+const int RestoreQualityDelayMs = 150;
+
+} // namespace
 
 CanvasView::CanvasView(QWidget *parent) : QGraphicsView(parent)
 {
     setRenderHint(QPainter::Antialiasing);
     setDragMode(QGraphicsView::ScrollHandDrag);
     setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    fullQualityHints = renderHints();
+
+    zoomTimer = new QTimer(this);
+    zoomTimer->setInterval(FrameBudgetMs);
+    connect(zoomTimer, &QTimer::timeout, this, &CanvasView::advanceZoom);
+
+    idleTimer = new QTimer(this);
+    idleTimer->setSingleShot(true);
+    idleTimer->setInterval(RestoreQualityDelayMs);
+    connect(idleTimer, &QTimer::timeout, this, &CanvasView::restoreQuality);
+}
+
+void CanvasView::setAdaptiveQuality(bool enabled)
+{
+    adaptiveQuality = enabled;
+    if (!enabled) {
+        restoreQuality();
+    }
+}
+
+void CanvasView::beginInteraction()
+{
+    idleTimer->start();
+    if (!adaptiveQuality || interacting) {
+        return;
+    }
+    interacting = true;
+    fullQualityHints = renderHints();
+    setRenderHint(QPainter::Antialiasing, false);
+    setRenderHint(QPainter::SmoothPixmapTransform, false);
+    if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+        canvas->setDraftMode(true);
+    }
+}
+
+void CanvasView::restoreQuality()
+{
+    if (panning || zoomTimer->isActive()) {
+        idleTimer->start();
+        return;
+    }
+    if (!interacting) {
+        return;
+    }
+    interacting = false;
+    setRenderHints(fullQualityHints);
+    if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+        canvas->setDraftMode(false);
+    }
+    viewport()->update();
 }
 
 void CanvasView::wheelEvent(QWheelEvent *event)
 {
-    qreal scaleFactor = (event->angleDelta().y() > 0) ? 1.15 : 1.0 / 1.15;
-    scale(scaleFactor, scaleFactor);
+    // 滚轮事件只累加目标缩放量，由定时器按帧逐步应用，避免每个刻度都触发一次完整重绘
+    pendingZoomLog += std::log(ZoomStep) * (event->angleDelta().y() / 120.0);
+    beginInteraction();
+    if (!zoomTimer->isActive()) {
+        frameTimer.start();
+        advanceZoom();
+        zoomTimer->start();
+    }
+    event->accept();
+}
+
+void CanvasView::advanceZoom()
+{
+    // 上一帧超出预算时一次应用更多缩放量，让动画在较少的帧内完成
+    const qreal elapsed = frameTimer.isValid() ? frameTimer.restart() : FrameBudgetMs;
+    const qreal fraction = qMin<qreal>(1.0, ZoomEasing * qMax<qreal>(1.0, elapsed / FrameBudgetMs));
+
+    qreal stepLog = pendingZoomLog * fraction;
+    if (qAbs(pendingZoomLog) < 1e-3) {
+        stepLog = pendingZoomLog;
+    }
+    pendingZoomLog -= stepLog;
+
+    qreal factor = std::exp(stepLog);
+    scale(factor, factor);
+
+    if (qFuzzyIsNull(pendingZoomLog)) {
+        pendingZoomLog = 0.0;
+        zoomTimer->stop();
+        idleTimer->start();
+    }
+}
+
+void CanvasView::mousePressEvent(QMouseEvent *event)
+{
+    QGraphicsView::mousePressEvent(event);
+    // ScrollHandDrag 只在场景没有接收点击时开始平移，此时视图会切换成抓手光标
+    if (dragMode() == QGraphicsView::ScrollHandDrag && event->button() == Qt::LeftButton
+        && viewport()->cursor().shape() == Qt::ClosedHandCursor) {
+        panning = true;
+        beginInteraction();
+    }
 }
 
 void CanvasView::mouseMoveEvent(QMouseEvent *event)
 {
     QGraphicsView::mouseMoveEvent(event);
+    if (panning) {
+        // 平移时视图会自行滚动重绘，不需要整个场景刷新
+        beginInteraction();
+        return;
+    }
     if (scene()) {
         scene()->update();
     }
 
     
 }
+
+void CanvasView::mouseReleaseEvent(QMouseEvent *event)
+{
+    QGraphicsView::mouseReleaseEvent(event);
+    if (panning && event->button() == Qt::LeftButton) {
+        panning = false;
+        idleTimer->start();
+    }
+}
@@ -5,6 +5,9 @@
 #define CANVASVIEW_H
 
 #include <QGraphicsView>
+#include <QElapsedTimer>
+
+class QTimer;
 
 class CanvasView : public QGraphicsView
 {
@@ -13,9 +16,33 @@ class CanvasView : public QGraphicsView
 public:
     explicit CanvasView(QWidget *parent = nullptr);
 
+    // 自适应画质：滚轮缩放或拖动平移期间关闭抗锯齿并使用低分辨率图像，停止操作后恢复
+    void setAdaptiveQuality(bool enabled);
+    bool isAdaptiveQuality() const { return adaptiveQuality; }
+
 protected:
     void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
+private slots:
+    void advanceZoom();
+    void restoreQuality();
+
+private:
+    void beginInteraction();
+
+    bool adaptiveQuality = true;
+    bool interacting = false;
+    bool panning = false;
+    QPainter::RenderHints fullQualityHints;
+
+    // 尚未应用的缩放量（取对数，便于把多个滚轮事件累加起来）
+    qreal pendingZoomLog = 0.0;
+    QTimer* zoomTimer;
+    QTimer* idleTimer;
+    QElapsedTimer frameTimer;
 };
 
 #endif // CANVASVIEW_H
@@ -0,0 +1,61 @@
+/* *************************************************************** */
+/* datasetreportdialog.cpp                 */
+/* *************************************************************** */
+#include "datasetreportdialog.h"
+
+#include <QVBoxLayout>
+#include <QPlainTextEdit>
+#include <QTreeWidget>
+#include <QHeaderView>
+
+DatasetReportDialog::DatasetReportDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("数据集检查结果");
+    resize(800, 600);
+
+    summaryEdit = new QPlainTextEdit(this);
+    summaryEdit->setReadOnly(true);
+    summaryEdit->setMaximumHeight(200);
+
+    issueTree = new QTreeWidget(this);
+    issueTree->setHeaderLabels({"文件", "形状", "标签", "问题"});
+    issueTree->setRootIsDecorated(false);
+    issueTree->setUniformRowHeights(true); // 问题数量可能很大
+    issueTree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(summaryEdit);
+    layout->addWidget(issueTree);
+
+    connect(issueTree, &QTreeWidget::itemClicked, this, &DatasetReportDialog::handleItemActivated);
+}
+
+void DatasetReportDialog::setReport(const QString &summary, const QList<DatasetIssue> &issues)
+{
+    summaryEdit->setPlainText(summary);
+    currentIssues = issues;
+
+    issueTree->clear();
+    QList<QTreeWidgetItem*> rows;
+    rows.reserve(issues.size());
+    for (int i = 0; i < issues.size(); ++i) {
+        const DatasetIssue &issue = issues[i];
+        QStringList shapeIndices;
+        for (int index : issue.shapeIndices) {
+            shapeIndices << QString::number(index);
+        }
+        auto row = new QTreeWidgetItem({issue.fileName, shapeIndices.join(", "), issue.label, issue.message});
+        row->setData(0, Qt::UserRole, i);
+        rows << row;
+    }
+    issueTree->addTopLevelItems(rows);
+}
+
+void DatasetReportDialog::handleItemActivated(QTreeWidgetItem *item)
+{
+    int index = item->data(0, Qt::UserRole).toInt();
+    if (index >= 0 && index < currentIssues.size()) {
+        emit issueActivated(currentIssues[index]);
+    }
+}
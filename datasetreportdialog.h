@@ -0,0 +1,36 @@
+/* *************************************************************** */
+/* datasetreportdialog.h                   */
+/* *************************************************************** */
+#ifndef DATASETREPORTDIALOG_H
+#define DATASETREPORTDIALOG_H
+
+#include <QDialog>
+#include "datasetvalidator.h"
+
+class QPlainTextEdit;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+// 显示数据集检查结果。单击问题条目会发出 issueActivated，由主窗口跳转到对应图片和形状。
+class DatasetReportDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DatasetReportDialog(QWidget *parent = nullptr);
+
+    void setReport(const QString& summary, const QList<DatasetIssue>& issues);
+
+signals:
+    void issueActivated(const DatasetIssue& issue);
+
+private slots:
+    void handleItemActivated(QTreeWidgetItem* item);
+
+private:
+    QPlainTextEdit* summaryEdit;
+    QTreeWidget* issueTree;
+    QList<DatasetIssue> currentIssues;
+};
+
+#endif // DATASETREPORTDIALOG_H
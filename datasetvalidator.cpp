@@ -0,0 +1,171 @@
+/* *************************************************************** */
+/* datasetvalidator.cpp                    */
+/* *************************************************************** */
+#include "datasetvalidator.h"
+#include "annotationfile.h"
+#include "shapegeometry.h"
+#include "imagesource.h"
+
+#include <QFileInfo>
+#include <QImageReader>
+#include <QRectF>
+#include <QtMath>
+
+namespace {
+
+void addIssue(DatasetStatistics &stats, const ValidationTask &task, int shapeIndex,
+              const QString &label, const QString &message)
+{
+    DatasetIssue issue;
+    issue.fileName = task.fileName;
+    if (shapeIndex >= 0) {
+        issue.shapeIndices << shapeIndex;
+    }
+    issue.label = label;
+    issue.message = message;
+    stats.issues.append(issue);
+}
+
+int areaBucket(qreal area)
+{
+    if (area < 1.0) {
+        return 0;
+    }
+    int bucket = int(std::floor(std::log2(area)));
+    return qBound(0, bucket, DatasetValidator::AreaBucketCount - 1);
+}
+
+} // namespace
+
+DatasetStatistics DatasetValidator::validateFile(const ValidationTask &task, const QStringList &knownLabels)
+{
+    DatasetStatistics stats;
+    stats.filesScanned = 1;
+
+    if (!QFileInfo::exists(task.jsonPath)) {
+        return stats;
+    }
+
+    AnnotationFile annotation;
+    QString error;
+    if (!readAnnotationFile(task.jsonPath, &annotation, &error)) {
+        addIssue(stats, task, -1, QString(), "无法解析标注文件: " + error);
+        return stats;
+    }
+    stats.filesAnnotated = 1;
+
+    QSize imageSize = annotation.imageSize;
+    if (!imageSize.isValid()) {
+        // sidecar 没有记录尺寸时只读取图片头部
+        if (std::unique_ptr<QIODevice> device = task.source->openEntry(task.fileName)) {
+            imageSize = QImageReader(device.get()).size();
+        }
+    }
+    const QRectF bounds = imageSize.isValid() ? QRectF(QPointF(0, 0), QSizeF(imageSize)) : QRectF();
+
+    int loadedIndex = 0;
+    for (const AnnotationShape &shape : annotation.shapes) {
+        bool isPolygon = shape.shapeType == "polygon";
+        bool isRectangle = shape.shapeType == "rectangle";
+        if (!isPolygon && !isRectangle) {
+            addIssue(stats, task, -1, shape.label, "不支持的形状类型: " + shape.shapeType);
+            continue;
+        }
+        const int shapeIndex = loadedIndex++;
+
+        stats.labelCounts[shape.label]++;
+        if (!knownLabels.contains(shape.label)) {
+            addIssue(stats, task, shapeIndex, shape.label, "标签不在标签列表中");
+        }
+
+        qreal area = 0.0;
+        if (isPolygon) {
+            if (shape.points.size() < 3) {
+                addIssue(stats, task, shapeIndex, shape.label,
+                         QString("多边形只有 %1 个点").arg(shape.points.size()));
+            } else {
+                area = ShapeGeometry::polygonArea(shape.points);
+                if (ShapeGeometry::isSelfIntersecting(shape.points)) {
+                    addIssue(stats, task, shapeIndex, shape.label, "多边形自相交");
+                }
+                if (qFuzzyIsNull(area)) {
+                    addIssue(stats, task, shapeIndex, shape.label, "多边形面积为零");
+                }
+            }
+        } else {
+            if (shape.points.size() != 2) {
+                addIssue(stats, task, shapeIndex, shape.label, "矩形必须由两个点定义");
+            } else {
+                QRectF rect = QRectF(shape.points[0], shape.points[1]).normalized();
+                area = rect.width() * rect.height();
+                if (qFuzzyIsNull(area)) {
+                    addIssue(stats, task, shapeIndex, shape.label, "矩形面积为零");
+                }
+            }
+        }
+
+        if (bounds.isValid()) {
+            for (const QPointF &point : shape.points) {
+                if (point.x() < bounds.left() || point.y() < bounds.top()
+                    || point.x() > bounds.right() || point.y() > bounds.bottom()) {
+                    addIssue(stats, task, shapeIndex, shape.label,
+                             QString("坐标 (%1, %2) 超出图片范围 %3x%4")
+                                 .arg(point.x()).arg(point.y())
+                                 .arg(imageSize.width()).arg(imageSize.height()));
+                    break;
+                }
+            }
+        }
+
+        QVector<int> &histogram = stats.areaHistograms[shape.label];
+        if (histogram.isEmpty()) {
+            histogram.resize(AreaBucketCount);
+        }
+        histogram[areaBucket(area)]++;
+    }
+    return stats;
+}
+
+void DatasetValidator::merge(DatasetStatistics &result, const DatasetStatistics &partial)
+{
+    result.filesScanned += partial.filesScanned;
+    result.filesAnnotated += partial.filesAnnotated;
+    for (auto it = partial.labelCounts.cbegin(); it != partial.labelCounts.cend(); ++it) {
+        result.labelCounts[it.key()] += it.value();
+    }
+    for (auto it = partial.areaHistograms.cbegin(); it != partial.areaHistograms.cend(); ++it) {
+        QVector<int> &histogram = result.areaHistograms[it.key()];
+        if (histogram.isEmpty()) {
+            histogram.resize(AreaBucketCount);
+        }
+        for (int i = 0; i < AreaBucketCount; ++i) {
+            histogram[i] += it.value().value(i);
+        }
+    }
+    result.issues.append(partial.issues);
+}
+
+QString DatasetValidator::formatSummary(const DatasetStatistics &statistics)
+{
+    QString text;
+    text += QString("已扫描 %1 张图片，其中 %2 张有标注，发现 %3 个问题。\n\n")
+                .arg(statistics.filesScanned)
+                .arg(statistics.filesAnnotated)
+                .arg(statistics.issues.size());
+
+    for (auto it = statistics.labelCounts.cbegin(); it != statistics.labelCounts.cend(); ++it) {
+        text += QString("%1: %2 个实例\n").arg(it.key()).arg(it.value());
+
+        const QVector<int> histogram = statistics.areaHistograms.value(it.key());
+        QStringList buckets;
+        for (int i = 0; i < histogram.size(); ++i) {
+            if (histogram[i] > 0) {
+                buckets << QString("2^%1: %2").arg(i).arg(histogram[i]);
+            }
+        }
+        if (!buckets.isEmpty()) {
+            text += "    面积分布  " + buckets.join("  ") + "\n";
+        }
+    }
+    return text;
+}
@@ -0,0 +1,55 @@
+/* *************************************************************** */
+/* datasetvalidator.h                      */
+/* *************************************************************** */
+#ifndef DATASETVALIDATOR_H
+#define DATASETVALIDATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+#include <QVector>
+
+class ImageSource;
+
+// 数据集检查中发现的一个问题
+struct DatasetIssue
+{
+    QString fileName;        // imageFiles 中的条目
+    QList<int> shapeIndices; // 在已加载形状（多边形/矩形）中的序号，为空表示整个文件
+    QString label;
+    QString message;
+};
+
+// 一个或多个 sidecar 文件的统计结果，可以逐个合并
+struct DatasetStatistics
+{
+    int filesScanned = 0;
+    int filesAnnotated = 0;
+    QMap<QString, int> labelCounts;
+    QMap<QString, QVector<int>> areaHistograms; // 按 floor(log2(面积)) 分桶
+    QList<DatasetIssue> issues;
+};
+
+// 需要检查的一张图片及其 sidecar
+struct ValidationTask
+{
+    QString fileName; // ImageSource 中的条目
+    const ImageSource* source = nullptr;
+    QString jsonPath;
+};
+
+class DatasetValidator
+{
+public:
+    static const int AreaBucketCount = 24;
+
+    // 检查单个 sidecar 文件（map 步骤），线程安全
+    static DatasetStatistics validateFile(const ValidationTask& task, const QStringList& knownLabels);
+    // 把部分结果合并到总结果中（reduce 步骤）
+    static void merge(DatasetStatistics& result, const DatasetStatistics& partial);
+    // 生成给用户看的统计摘要
+    static QString formatSummary(const DatasetStatistics& statistics);
+};
+
+#endif // DATASETVALIDATOR_H
@@ -0,0 +1,155 @@
+/* *************************************************************** */
+/* duplicatefinder.cpp                       */
+/* *************************************************************** */
+#include "duplicatefinder.h"
+#include "imagesource.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QVector>
+#include <numeric>
+
+namespace {
+
+const int CacheVersion = 1;
+
+// dHash 对平移更敏感，确认时允许的距离放宽一些
+const int DifferenceHashSlack = 4;
+
+int findRoot(QVector<int> &parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+} // namespace
+
+HashRecord DuplicateFinder::hashEntry(const HashTask &task)
+{
+    HashRecord record;
+    record.entry = task.entry;
+    record.stamp = task.source->entryStamp(task.entry);
+    if (task.cached.hash.valid && task.cached.stamp == record.stamp) {
+        record.hash = task.cached.hash;
+        return record;
+    }
+    record.hash = ImageHash::fromData(task.source->readEntry(task.entry));
+    return record;
+}
+
+QHash<QString, HashRecord> DuplicateFinder::readCache(const QString &path)
+{
+    QHash<QString, HashRecord> records;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return records;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != CacheVersion) {
+        return records;
+    }
+
+    const QJsonObject entries = root.value("entries").toObject();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        const QJsonObject object = it.value().toObject();
+        HashRecord record;
+        record.entry = it.key();
+        record.stamp = object.value("stamp").toString();
+        bool dOk = false;
+        bool pOk = false;
+        record.hash.dHash = object.value("dhash").toString().toULongLong(&dOk, 16);
+        record.hash.pHash = object.value("phash").toString().toULongLong(&pOk, 16);
+        record.hash.valid = dOk && pOk;
+        if (record.hash.valid) {
+            records.insert(record.entry, record);
+        }
+    }
+    return records;
+}
+
+bool DuplicateFinder::writeCache(const QString &path, const QList<HashRecord> &records)
+{
+    QJsonObject entries;
+    for (const HashRecord &record : records) {
+        if (!record.hash.valid) {
+            continue;
+        }
+        QJsonObject object;
+        object["stamp"] = record.stamp;
+        object["dhash"] = QString::number(record.hash.dHash, 16);
+        object["phash"] = QString::number(record.hash.pHash, 16);
+        entries[record.entry] = object;
+    }
+    QJsonObject root;
+    root["version"] = CacheVersion;
+    root["entries"] = entries;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+QList<QStringList> DuplicateFinder::findGroups(const QList<HashRecord> &records, int maxDistance)
+{
+    maxDistance = qBound(0, maxDistance, 63);
+
+    // 鸽巢原理：把 64 位 pHash 分成 maxDistance+1 段，距离不超过 maxDistance 的两个哈希
+    // 至少有一段完全相同。每段建一个桶表，只比较落在同一个桶里的图片。
+    const int bandCount = maxDistance + 1;
+    QVector<int> bandShift(bandCount);
+    QVector<quint64> bandMask(bandCount);
+    int shift = 0;
+    for (int band = 0; band < bandCount; ++band) {
+        const int width = 64 / bandCount + (band < 64 % bandCount ? 1 : 0);
+        bandShift[band] = shift;
+        bandMask[band] = width >= 64 ? ~quint64(0) : ((quint64(1) << width) - 1);
+        shift += width;
+    }
+
+    QVector<int> parent(records.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    QVector<QHash<quint64, QVector<int>>> buckets(bandCount);
+    for (int i = 0; i < records.size(); ++i) {
+        const ImageHash &hash = records[i].hash;
+        if (!hash.valid) {
+            continue;
+        }
+        for (int band = 0; band < bandCount; ++band) {
+            QVector<int> &bucket = buckets[band][(hash.pHash >> bandShift[band]) & bandMask[band]];
+            for (int j : bucket) {
+                if (findRoot(parent, i) == findRoot(parent, j)) {
+                    continue;
+                }
+                const ImageHash &other = records[j].hash;
+                if (hammingDistance(hash.pHash, other.pHash) <= maxDistance
+                    && hammingDistance(hash.dHash, other.dHash) <= maxDistance + DifferenceHashSlack) {
+                    parent[findRoot(parent, i)] = findRoot(parent, j);
+                }
+            }
+            bucket.append(i);
+        }
+    }
+
+    // 按每组第一次出现的位置排列
+    QHash<int, int> groupOfRoot;
+    QList<QStringList> groups;
+    for (int i = 0; i < records.size(); ++i) {
+        const int root = findRoot(parent, i);
+        auto it = groupOfRoot.find(root);
+        if (it == groupOfRoot.end()) {
+            it = groupOfRoot.insert(root, groups.size());
+            groups.append(QStringList());
+        }
+        groups[it.value()].append(records[i].entry);
+    }
+    groups.removeIf([](const QStringList &group) { return group.size() < 2; });
+    return groups;
+}
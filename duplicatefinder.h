@@ -0,0 +1,46 @@
+/* *************************************************************** */
+/* duplicatefinder.h                         */
+/* *************************************************************** */
+#ifndef DUPLICATEFINDER_H
+#define DUPLICATEFINDER_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include "imagehash.h"
+
+class ImageSource;
+
+struct HashRecord
+{
+    QString entry;
+    QString stamp; // 计算哈希时条目的版本标识，见 ImageSource::entryStamp
+    ImageHash hash;
+};
+
+// 一个工作线程处理的条目，cached 是缓存文件中的旧记录（可能已过期）
+struct HashTask
+{
+    QString entry;
+    const ImageSource* source = nullptr;
+    HashRecord cached;
+};
+
+// 近似重复图片检测：并行计算感知哈希，按修改时间缓存，
+// 用分段的汉明距离索引找出候选对并合并成组。
+class DuplicateFinder
+{
+public:
+    // 条目未变化时直接返回缓存的记录，否则解码缩略图重新计算。线程安全。
+    static HashRecord hashEntry(const HashTask& task);
+
+    static QHash<QString, HashRecord> readCache(const QString& path);
+    static bool writeCache(const QString& path, const QList<HashRecord>& records);
+
+    // 把 pHash 和 dHash 的汉明距离都不超过 maxDistance 的图片合并成组。
+    // 只返回至少两张图片的组，组内和组间都按 records 中的顺序排列。
+    static QList<QStringList> findGroups(const QList<HashRecord>& records, int maxDistance);
+};
+
+#endif // DUPLICATEFINDER_H
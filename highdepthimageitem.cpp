@@ -0,0 +1,240 @@
+/* *************************************************************** */
+/* highdepthimageitem.cpp                      */
+/* *************************************************************** */
+#include "highdepthimageitem.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtConcurrent>
+#include <QtMath>
+#include <cmath>
+
+namespace {
+
+const int LutSize = 65536;
+const int BandRows = 64;                   // 并行渲染时每个任务处理的行数
+const qint64 MaxHistogramSamples = 1 << 20; // 估计窗宽窗位时最多采样的像素数
+const double LowPercentile = 0.005;
+const double HighPercentile = 0.995;
+
+inline quint16 luminance(const QRgba64 &pixel)
+{
+    return quint16((pixel.red() + 2 * pixel.green() + pixel.blue()) >> 2);
+}
+
+// 查找表以参数传入，工作线程使用的是调用方取得的快照
+void renderRegion(const QImage &sourceImage, const QVector<QRgb> &grayLut, const QVector<uchar> &channelLut,
+                  const QRect &source, QImage *target)
+{
+    const int width = target->width();
+    const int height = target->height();
+    const bool identityColumns = width == source.width();
+
+    // 每个目标像素中心对应的源像素行列
+    QVector<int> columns(width);
+    for (int x = 0; x < width; ++x) {
+        columns[x] = source.x() + qMin(source.width() - 1, int((x + 0.5) * source.width() / width));
+    }
+    QVector<int> rows(height);
+    for (int y = 0; y < height; ++y) {
+        rows[y] = source.y() + qMin(source.height() - 1, int((y + 0.5) * source.height() / height));
+    }
+
+    // 先取得可写指针，避免在工作线程中触发 detach
+    uchar *targetBits = target->bits();
+    const qsizetype targetStride = target->bytesPerLine();
+    const bool grayscale = sourceImage.format() == QImage::Format_Grayscale16;
+
+    // 查表没有分支和跨像素依赖；按行块分给线程池，每块内逐行连续写出
+    auto renderBand = [&](int firstRow) {
+        const int lastRow = qMin(firstRow + BandRows, height);
+        const int *column = columns.constData();
+        for (int y = firstRow; y < lastRow; ++y) {
+            QRgb *out = reinterpret_cast<QRgb*>(targetBits + y * targetStride);
+            if (grayscale) {
+                const QRgb *lut = grayLut.constData();
+                const quint16 *in = reinterpret_cast<const quint16*>(sourceImage.constScanLine(rows[y]));
+                if (identityColumns) {
+                    in += source.x();
+                    for (int x = 0; x < width; ++x) {
+                        out[x] = lut[in[x]];
+                    }
+                } else {
+                    for (int x = 0; x < width; ++x) {
+                        out[x] = lut[in[column[x]]];
+                    }
+                }
+            } else {
+                const uchar *lut = channelLut.constData();
+                const QRgba64 *in = reinterpret_cast<const QRgba64*>(sourceImage.constScanLine(rows[y]));
+                for (int x = 0; x < width; ++x) {
+                    const QRgba64 pixel = in[column[x]];
+                    out[x] = 0xff000000u | (uint(lut[pixel.red()]) << 16) | (uint(lut[pixel.green()]) << 8)
+                             | uint(lut[pixel.blue()]);
+                }
+            }
+        }
+    };
+
+    QVector<int> bands;
+    for (int y = 0; y < height; y += BandRows) {
+        bands.append(y);
+    }
+    if (bands.size() > 1) {
+        QtConcurrent::blockingMap(bands, renderBand);
+    } else if (!bands.isEmpty()) {
+        renderBand(bands.first());
+    }
+}
+
+} // namespace
+
+HighDepthImageItem::HighDepthImageItem(const QImage &image, QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+    , sourceImage(image.format() == QImage::Format_Grayscale16 ? image : image.convertToFormat(QImage::Format_RGBA64))
+{
+    // 需要 exposedRect 才能只渲染可见区域
+    setFlag(ItemUsesExtendedStyleOption);
+    window = automaticWindow();
+    rebuildLookupTables();
+}
+
+bool HighDepthImageItem::isHighDepth(const QImage &image)
+{
+    switch (image.format()) {
+    case QImage::Format_Grayscale16:
+    case QImage::Format_RGB30:
+    case QImage::Format_A2RGB30_Premultiplied:
+    case QImage::Format_BGR30:
+    case QImage::Format_A2BGR30_Premultiplied:
+        return true;
+    default:
+        return image.depth() > 32;
+    }
+}
+
+void HighDepthImageItem::setDisplayWindow(const DisplayWindow &newWindow)
+{
+    window = newWindow;
+    window.width = qMax(1.0, window.width);
+    window.gamma = qBound(0.05, window.gamma, 20.0);
+    rebuildLookupTables();
+    update();
+}
+
+DisplayWindow HighDepthImageItem::automaticWindow() const
+{
+    DisplayWindow result = window;
+    if (sourceImage.isNull()) {
+        return result;
+    }
+
+    // 大图隔行隔列采样
+    const qint64 pixelCount = qint64(sourceImage.width()) * sourceImage.height();
+    const int step = qMax(1, int(std::ceil(std::sqrt(double(pixelCount) / MaxHistogramSamples))));
+    QVector<quint32> histogram(LutSize, 0);
+    qint64 total = 0;
+    for (int y = 0; y < sourceImage.height(); y += step) {
+        if (isGrayscale()) {
+            const quint16 *row = reinterpret_cast<const quint16*>(sourceImage.constScanLine(y));
+            for (int x = 0; x < sourceImage.width(); x += step) {
+                ++histogram[row[x]];
+            }
+        } else {
+            const QRgba64 *row = reinterpret_cast<const QRgba64*>(sourceImage.constScanLine(y));
+            for (int x = 0; x < sourceImage.width(); x += step) {
+                ++histogram[luminance(row[x])];
+            }
+        }
+        total += (sourceImage.width() + step - 1) / step;
+    }
+
+    const qint64 lowCount = qint64(total * LowPercentile);
+    const qint64 highCount = qint64(total * HighPercentile);
+    int low = 0;
+    int high = LutSize - 1;
+    qint64 cumulative = 0;
+    for (int value = 0; value < LutSize; ++value) {
+        const qint64 next = cumulative + histogram[value];
+        if (cumulative <= lowCount && next > lowCount) {
+            low = value;
+        }
+        if (cumulative < highCount && next >= highCount) {
+            high = value;
+            break;
+        }
+        cumulative = next;
+    }
+
+    result.center = (low + high) / 2.0;
+    result.width = qMax(1, high - low + 1);
+    return result;
+}
+
+void HighDepthImageItem::setDraftMode(bool enabled)
+{
+    if (draftMode != enabled) {
+        draftMode = enabled;
+        update();
+    }
+}
+
+void HighDepthImageItem::rebuildLookupTables()
+{
+    grayLut.resize(LutSize);
+    channelLut.resize(LutSize);
+    const double low = window.center - window.width / 2;
+    const double inverseGamma = 1.0 / window.gamma;
+    for (int value = 0; value < LutSize; ++value) {
+        double t = qBound(0.0, (value - low) / window.width, 1.0);
+        if (inverseGamma != 1.0) {
+            t = std::pow(t, inverseGamma);
+        }
+        const uchar level = uchar(qRound(t * 255));
+        channelLut[value] = level;
+        grayLut[value] = qRgb(level, level, level);
+    }
+}
+
+QImage HighDepthImageItem::toRgb32() const
+{
+    return rgbConverter()();
+}
+
+std::function<QImage()> HighDepthImageItem::rgbConverter() const
+{
+    // 复制隐式共享的图片和查找表；之后 rebuildLookupTables 写入时会分离出新的副本
+    return [image = sourceImage, gray = grayLut, channel = channelLut]() {
+        QImage result(image.size(), QImage::Format_RGB32);
+        if (!result.isNull()) {
+            renderRegion(image, gray, channel, image.rect(), &result);
+        }
+        return result;
+    };
+}
+
+QRectF HighDepthImageItem::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), sourceImage.size());
+}
+
+void HighDepthImageItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+    const QRect source = option->exposedRect.toAlignedRect() & sourceImage.rect();
+    if (source.isEmpty()) {
+        return;
+    }
+
+    // 缩小显示时按屏幕分辨率采样；放大显示时按图片分辨率采样，由 painter 放大
+    const QTransform transform = painter->worldTransform();
+    qreal scale = qMin<qreal>(1.0, qSqrt(transform.m11() * transform.m11() + transform.m12() * transform.m12()));
+    if (draftMode) {
+        scale *= 0.5;
+    }
+    const QSize size(qMax(1, qCeil(source.width() * scale)), qMax(1, qCeil(source.height() * scale)));
+
+    QImage region(size, QImage::Format_RGB32);
+    renderRegion(sourceImage, grayLut, channelLut, source, &region);
+    painter->drawImage(QRectF(source), region);
+}
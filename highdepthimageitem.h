@@ -0,0 +1,61 @@
+/* *************************************************************** */
+/* highdepthimageitem.h                      */
+/* *************************************************************** */
+#ifndef HIGHDEPTHIMAGEITEM_H
+#define HIGHDEPTHIMAGEITEM_H
+
+#include <QGraphicsItem>
+#include <QImage>
+#include <QVector>
+#include <functional>
+
+// 窗宽窗位和 gamma，单位是 16 位原始值（0..65535）
+struct DisplayWindow
+{
+    double center = 32767.5;
+    double width = 65536;
+    double gamma = 1.0;
+};
+
+// 以原始位深保存 16 位灰度 / 彩色图片的背景item。
+// 不预先生成 8 位副本：每次重绘只对暴露区域按屏幕分辨率采样，经查找表映射成 8 位后绘制，
+// 调整窗宽窗位只需要重建查找表。
+class HighDepthImageItem : public QGraphicsItem
+{
+public:
+    explicit HighDepthImageItem(const QImage& image, QGraphicsItem *parent = nullptr);
+
+    // 超过每通道 8 位的图片
+    static bool isHighDepth(const QImage& image);
+
+    QImage image() const { return sourceImage; }
+    bool isGrayscale() const { return sourceImage.format() == QImage::Format_Grayscale16; }
+
+    void setDisplayWindow(const DisplayWindow& window);
+    DisplayWindow displayWindow() const { return window; }
+    // 按直方图的 0.5% / 99.5% 分位数估计窗宽窗位，gamma 不变
+    DisplayWindow automaticWindow() const;
+
+    // 草稿模式下按一半的屏幕分辨率采样
+    void setDraftMode(bool enabled);
+
+    // 整张图片按当前窗宽窗位转换成 RGB32，供魔棒、跟踪等分析使用
+    QImage toRgb32() const;
+    // 在 GUI 线程取得图片和查找表的快照，返回的函数可以在工作线程中执行 toRgb32，
+    // 之后调整窗宽窗位不影响它
+    std::function<QImage()> rgbConverter() const;
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+private:
+    void rebuildLookupTables();
+
+    QImage sourceImage; // Format_Grayscale16 或 Format_RGBA64
+    DisplayWindow window;
+    QVector<QRgb> grayLut;    // 灰度值 -> 不透明灰色像素
+    QVector<uchar> channelLut; // 彩色图片每个通道 16 位 -> 8 位
+    bool draftMode = false;
+};
+
+#endif // HIGHDEPTHIMAGEITEM_H
@@ -0,0 +1,110 @@
+/* *************************************************************** */
+/* imagehash.cpp                           */
+/* *************************************************************** */
+#include "imagehash.h"
+
+#include <QBuffer>
+#include <QImage>
+#include <QImageReader>
+#include <QVector>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+const int HashImageSize = 32; // pHash 的 DCT 尺寸，也是解码尺寸
+const int LowFrequencies = 8; // pHash 取左上角 8x8 的系数
+
+quint64 differenceHash(const QImage &gray)
+{
+    // 9x8 的缩略图，每行比较相邻的 8 对像素
+    const QImage small = gray.scaled(9, 8, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    quint64 hash = 0;
+    for (int y = 0; y < 8; ++y) {
+        const uchar *row = small.constScanLine(y);
+        for (int x = 0; x < 8; ++x) {
+            hash = (hash << 1) | quint64(row[x] < row[x + 1]);
+        }
+    }
+    return hash;
+}
+
+quint64 perceptualHash(const QImage &gray)
+{
+    // 只需要前 8 个频率，可分离的两次一维 DCT，只算用到的系数
+    static const QVector<double> cosines = [] {
+        QVector<double> table(LowFrequencies * HashImageSize);
+        for (int u = 0; u < LowFrequencies; ++u) {
+            for (int x = 0; x < HashImageSize; ++x) {
+                table[u * HashImageSize + x] = std::cos((2 * x + 1) * u * M_PI / (2 * HashImageSize));
+            }
+        }
+        return table;
+    }();
+
+    double rows[HashImageSize][LowFrequencies];
+    for (int y = 0; y < HashImageSize; ++y) {
+        const uchar *line = gray.constScanLine(y);
+        for (int u = 0; u < LowFrequencies; ++u) {
+            const double *c = cosines.constData() + u * HashImageSize;
+            double sum = 0;
+            for (int x = 0; x < HashImageSize; ++x) {
+                sum += line[x] * c[x];
+            }
+            rows[y][u] = sum;
+        }
+    }
+
+    double coefficients[LowFrequencies * LowFrequencies];
+    for (int v = 0; v < LowFrequencies; ++v) {
+        const double *c = cosines.constData() + v * HashImageSize;
+        for (int u = 0; u < LowFrequencies; ++u) {
+            double sum = 0;
+            for (int y = 0; y < HashImageSize; ++y) {
+                sum += rows[y][u] * c[y];
+            }
+            coefficients[v * LowFrequencies + u] = sum;
+        }
+    }
+
+    // 以中位数为阈值；直流分量只反映整体亮度，不参与中位数
+    double sorted[LowFrequencies * LowFrequencies - 1];
+    std::copy(coefficients + 1, coefficients + LowFrequencies * LowFrequencies, sorted);
+    const int middle = (LowFrequencies * LowFrequencies - 1) / 2;
+    std::nth_element(sorted, sorted + middle, sorted + LowFrequencies * LowFrequencies - 1);
+    const double median = sorted[middle];
+
+    quint64 hash = 0;
+    for (int i = 0; i < LowFrequencies * LowFrequencies; ++i) {
+        hash = (hash << 1) | quint64(coefficients[i] > median);
+    }
+    return hash;
+}
+
+} // namespace
+
+ImageHash ImageHash::fromData(const QByteArray &data)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    reader.setScaledSize(QSize(HashImageSize, HashImageSize));
+    return fromImage(reader.read());
+}
+
+ImageHash ImageHash::fromImage(const QImage &image)
+{
+    ImageHash hash;
+    if (image.isNull()) {
+        return hash;
+    }
+    QImage gray = image.convertToFormat(QImage::Format_Grayscale8);
+    if (gray.size() != QSize(HashImageSize, HashImageSize)) {
+        gray = gray.scaled(HashImageSize, HashImageSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    hash.dHash = differenceHash(gray);
+    hash.pHash = perceptualHash(gray);
+    hash.valid = true;
+    return hash;
+}
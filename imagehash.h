@@ -0,0 +1,30 @@
+/* *************************************************************** */
+/* imagehash.h                             */
+/* *************************************************************** */
+#ifndef IMAGEHASH_H
+#define IMAGEHASH_H
+
+#include <QtGlobal>
+
+class QByteArray;
+class QImage;
+
+// 图片的感知哈希：dHash（相邻像素梯度）和 pHash（低频 DCT 系数），各 64 位。
+// 内容近似的图片哈希的汉明距离很小。
+struct ImageHash
+{
+    quint64 dHash = 0;
+    quint64 pHash = 0;
+    bool valid = false;
+
+    // 只解码缩小到 32x32 的图片，JPEG 等格式在解码时直接缩小
+    static ImageHash fromData(const QByteArray& data);
+    static ImageHash fromImage(const QImage& image);
+};
+
+inline int hammingDistance(quint64 a, quint64 b)
+{
+    return qPopulationCount(a ^ b);
+}
+
+#endif // IMAGEHASH_H
@@ -0,0 +1,502 @@
+/* *************************************************************** */
+/* imagesource.cpp                         */
+/* *************************************************************** */
+#include "imagesource.h"
+#include "annotationfile.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QVector>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+#ifdef QTLABELER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+// ---------------------------------------------------------------- 文件夹
+
+class DirectoryImageSource : public ImageSource
+{
+public:
+    explicit DirectoryImageSource(const QString &path) : dir(path) {}
+
+    QString location() const override { return dir.absolutePath(); }
+
+    QStringList entries() const override
+    {
+        QStringList filters;
+        filters << "*.jpg" << "*.jpeg" << "*.png" << "*.bmp" << "*.tif" << "*.tiff";
+        return dir.entryList(filters, QDir::Files | QDir::NoDotAndDotDot);
+    }
+
+    QByteArray readEntry(const QString &entry) const override
+    {
+        QFile file(dir.filePath(entry));
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QByteArray();
+        }
+        return file.readAll();
+    }
+
+    std::unique_ptr<QIODevice> openEntry(const QString &entry) const override
+    {
+        auto file = std::make_unique<QFile>(dir.filePath(entry));
+        if (!file->open(QIODevice::ReadOnly)) {
+            return nullptr;
+        }
+        return file;
+    }
+
+    QString annotationPath(const QString &entry) const override
+    {
+        return annotationPathForImage(dir.filePath(entry));
+    }
+
+    QString entryStamp(const QString &entry) const override
+    {
+        QFileInfo info(dir.filePath(entry));
+        return QString("%1:%2").arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size());
+    }
+
+    QString cachePath(const QString &name) const override
+    {
+        return dir.filePath(".qtlabeler." + name);
+    }
+
+private:
+    QDir dir;
+};
+
+// ---------------------------------------------------------------- 归档
+
+struct ArchiveMember
+{
+    QString name;
+    qint64 offset = 0;          // 数据在归档中的偏移
+    qint64 size = 0;            // 解压后的大小
+    qint64 compressedSize = 0;
+    quint16 method = 0;         // 0: 未压缩, 8: deflate
+};
+
+const quint32 IndexMagic = 0x514c4958; // "QLIX"
+const quint32 IndexVersion = 2; // 2: 支持 zip64，旧索引可能缺少成员
+
+class ArchiveImageSource : public ImageSource
+{
+public:
+    bool open(const QString &path, QString *errorString);
+
+    QString location() const override { return archiveFile.fileName(); }
+    QStringList entries() const override { return entryNames; }
+    QByteArray readEntry(const QString &entry) const override;
+    std::unique_ptr<QIODevice> openEntry(const QString &entry) const override;
+    QString annotationPath(const QString &entry) const override
+    {
+        return QDir(archiveFile.fileName() + ".annotations").filePath(annotationPathForImage(entry));
+    }
+    QString entryStamp(const QString &entry) const override;
+    QString cachePath(const QString &name) const override { return archiveFile.fileName() + "." + name; }
+
+private:
+    bool scanTar(QString *errorString);
+    bool scanZip(QString *errorString);
+    bool loadIndex(const QString &indexPath);
+    void saveIndex(const QString &indexPath) const;
+    void addMember(const ArchiveMember &member);
+
+    QFile archiveFile;
+    const uchar *data = nullptr;
+    qint64 dataSize = 0;
+    QVector<ArchiveMember> members;
+    QHash<QString, int> memberIndex;
+    QStringList entryNames;
+};
+
+qint64 parseTarNumber(const uchar *field, int length)
+{
+    // GNU 扩展：最高位为1时是大端二进制数，用于超过 8GB 的成员
+    if (field[0] & 0x80) {
+        qint64 value = field[0] & 0x7f;
+        for (int i = 1; i < length; ++i) {
+            value = (value << 8) | field[i];
+        }
+        return value;
+    }
+    qint64 value = 0;
+    for (int i = 0; i < length && field[i]; ++i) {
+        if (field[i] >= '0' && field[i] <= '7') {
+            value = value * 8 + (field[i] - '0');
+        }
+    }
+    return value;
+}
+
+QString tarString(const uchar *field, int length)
+{
+    return QString::fromUtf8(reinterpret_cast<const char *>(field), int(qstrnlen(reinterpret_cast<const char *>(field), length)));
+}
+
+bool ArchiveImageSource::open(const QString &path, QString *errorString)
+{
+    archiveFile.setFileName(path);
+    if (!archiveFile.open(QIODevice::ReadOnly)) {
+        *errorString = archiveFile.errorString();
+        return false;
+    }
+    dataSize = archiveFile.size();
+    data = archiveFile.map(0, dataSize);
+    if (!data) {
+        *errorString = "无法映射归档文件: " + archiveFile.errorString();
+        return false;
+    }
+
+    // 成员索引保存在归档旁边，归档大小和修改时间不变时直接复用，避免再次扫描整个归档
+    const QString indexPath = path + ".index";
+    if (!loadIndex(indexPath)) {
+        bool ok = path.endsWith(".zip", Qt::CaseInsensitive) ? scanZip(errorString) : scanTar(errorString);
+        if (!ok) {
+            return false;
+        }
+        saveIndex(indexPath);
+    }
+
+    for (int i = 0; i < members.size(); ++i) {
+        memberIndex.insert(members[i].name, i);
+        entryNames.append(members[i].name);
+    }
+    std::sort(entryNames.begin(), entryNames.end());
+    return true;
+}
+
+void ArchiveImageSource::addMember(const ArchiveMember &member)
+{
+    if (isImageName(member.name)) {
+        members.append(member);
+    }
+}
+
+bool ArchiveImageSource::scanTar(QString *errorString)
+{
+    const qint64 BlockSize = 512;
+    QString longName;
+    qint64 position = 0;
+    while (position + BlockSize <= dataSize) {
+        const uchar *header = data + position;
+        if (header[0] == 0) {
+            break; // 两个全零块表示归档结束
+        }
+
+        const qint64 size = parseTarNumber(header + 124, 12);
+        const char type = char(header[156]);
+        const qint64 dataOffset = position + BlockSize;
+        if (dataOffset + size > dataSize) {
+            *errorString = "tar 归档已截断";
+            return false;
+        }
+
+        if (type == 'L') {
+            // GNU 长文件名：数据块内容是下一个成员的名字
+            longName = QString::fromUtf8(reinterpret_cast<const char *>(data + dataOffset),
+                                         int(qstrnlen(reinterpret_cast<const char *>(data + dataOffset), size)));
+        } else if (type == 'x') {
+            // pax 扩展头：记录格式为 "<长度> key=value\n"
+            const QByteArray records = QByteArray::fromRawData(reinterpret_cast<const char *>(data + dataOffset), qsizetype(size));
+            for (const QByteArray &record : records.split('\n')) {
+                int keyStart = record.indexOf(' ');
+                if (keyStart >= 0 && record.mid(keyStart + 1).startsWith("path=")) {
+                    longName = QString::fromUtf8(record.mid(keyStart + 6));
+                }
+            }
+        } else if (type == '0' || type == '\0' || type == '7') {
+            QString name = longName;
+            if (name.isEmpty()) {
+                name = tarString(header, 100);
+                // ustar 格式把长路径拆成 prefix 和 name 两部分
+                // GNU 头的魔数是 "ustar  "，345 处存放的是 atime/ctime，不是路径前缀
+                if (memcmp(header + 257, "ustar", 6) == 0 && header[345]) {
+                    name = tarString(header + 345, 155) + '/' + name;
+                }
+            }
+            longName.clear();
+
+            ArchiveMember member;
+            member.name = name;
+            member.offset = dataOffset;
+            member.size = size;
+            member.compressedSize = size;
+            addMember(member);
+        } else {
+            longName.clear();
+        }
+
+        position = dataOffset + (size + BlockSize - 1) / BlockSize * BlockSize;
+    }
+    return true;
+}
+
+bool ArchiveImageSource::scanZip(QString *errorString)
+{
+    // 从文件末尾向前查找中央目录结束记录（其后最多有 65535 字节的注释）
+    const qint64 EndRecordSize = 22;
+    qint64 endRecord = -1;
+    for (qint64 pos = dataSize - EndRecordSize; pos >= 0 && pos >= dataSize - EndRecordSize - 65535; --pos) {
+        if (qFromLittleEndian<quint32>(data + pos) == 0x06054b50) {
+            endRecord = pos;
+            break;
+        }
+    }
+    if (endRecord < 0) {
+        *errorString = "不是有效的 zip 归档";
+        return false;
+    }
+
+    qint64 entryCount = qFromLittleEndian<quint16>(data + endRecord + 10);
+    qint64 directoryOffset = qFromLittleEndian<quint32>(data + endRecord + 16);
+    // 成员数达到 0xFFFF 或偏移为 0xFFFFFFFF 时，真实的值在 zip64 中央目录结束记录中
+    bool countKnown = entryCount != 0xffff;
+    const qint64 LocatorSize = 20;
+    const qint64 Zip64EndRecordSize = 56;
+    if (endRecord >= LocatorSize && qFromLittleEndian<quint32>(data + endRecord - LocatorSize) == 0x07064b50) {
+        const quint64 zip64EndRecord = qFromLittleEndian<quint64>(data + endRecord - LocatorSize + 8);
+        if (dataSize < Zip64EndRecordSize || zip64EndRecord > quint64(dataSize - Zip64EndRecordSize)
+            || qFromLittleEndian<quint32>(data + zip64EndRecord) != 0x06064b50) {
+            *errorString = "zip64 中央目录结束记录已损坏";
+            return false;
+        }
+        entryCount = qint64(qFromLittleEndian<quint64>(data + zip64EndRecord + 32));
+        directoryOffset = qint64(qFromLittleEndian<quint64>(data + zip64EndRecord + 48));
+        countKnown = true;
+    } else if (directoryOffset == 0xffffffff) {
+        *errorString = "zip64 归档缺少中央目录定位记录";
+        return false;
+    }
+    if (directoryOffset < 0 || directoryOffset >= dataSize) {
+        *errorString = "zip 中央目录已损坏";
+        return false;
+    }
+
+    qint64 position = directoryOffset;
+    for (qint64 i = 0; !countKnown || i < entryCount; ++i) {
+        const bool hasHeader = position + 46 <= dataSize && qFromLittleEndian<quint32>(data + position) == 0x02014b50;
+        if (!countKnown && !hasHeader) {
+            // 没有 zip64 记录而成员数饱和在 0xFFFF 的归档：一直读到中央目录结束
+            break;
+        }
+        if (!hasHeader) {
+            *errorString = "zip 中央目录已损坏";
+            return false;
+        }
+        const uchar *entry = data + position;
+        const quint16 method = qFromLittleEndian<quint16>(entry + 10);
+        qint64 compressedSize = qFromLittleEndian<quint32>(entry + 20);
+        qint64 size = qFromLittleEndian<quint32>(entry + 24);
+        const quint16 nameLength = qFromLittleEndian<quint16>(entry + 28);
+        const quint16 extraLength = qFromLittleEndian<quint16>(entry + 30);
+        const quint16 commentLength = qFromLittleEndian<quint16>(entry + 32);
+        qint64 localOffset = qFromLittleEndian<quint32>(entry + 42);
+        if (position + 46 + nameLength + extraLength > dataSize) {
+            *errorString = "zip 中央目录已损坏";
+            return false;
+        }
+        const QString name = QString::fromUtf8(reinterpret_cast<const char *>(entry + 46), nameLength);
+
+        // zip64 扩展字段：按顺序只包含在中央目录中为 0xFFFFFFFF 的那些值
+        const uchar *extra = entry + 46 + nameLength;
+        for (int offset = 0; offset + 4 <= extraLength;) {
+            const quint16 id = qFromLittleEndian<quint16>(extra + offset);
+            const quint16 length = qFromLittleEndian<quint16>(extra + offset + 2);
+            if (id == 0x0001) {
+                const uchar *field = extra + offset + 4;
+                const uchar *fieldEnd = field + qMin<int>(length, extraLength - offset - 4);
+                auto readZip64 = [&field, fieldEnd](qint64 *value) {
+                    if (*value == 0xffffffff && field + 8 <= fieldEnd) {
+                        *value = qint64(qFromLittleEndian<quint64>(field));
+                        field += 8;
+                    }
+                };
+                readZip64(&size);
+                readZip64(&compressedSize);
+                readZip64(&localOffset);
+                break;
+            }
+            offset += 4 + length;
+        }
+        position += 46 + nameLength + extraLength + commentLength;
+
+        if (method != 0 && method != 8) {
+            continue;
+        }
+        if (localOffset < 0 || localOffset + 30 > dataSize || qFromLittleEndian<quint32>(data + localOffset) != 0x04034b50) {
+            continue;
+        }
+        // 本地文件头中的扩展字段长度可能与中央目录不同，以本地文件头为准
+        const quint16 localNameLength = qFromLittleEndian<quint16>(data + localOffset + 26);
+        const quint16 localExtraLength = qFromLittleEndian<quint16>(data + localOffset + 28);
+
+        ArchiveMember member;
+        member.name = name;
+        member.offset = localOffset + 30 + localNameLength + localExtraLength;
+        member.size = size;
+        member.compressedSize = compressedSize;
+        member.method = method;
+        if (member.offset + member.compressedSize <= dataSize) {
+            addMember(member);
+        }
+    }
+    return true;
+}
+
+bool ArchiveImageSource::loadIndex(const QString &indexPath)
+{
+    QFile file(indexPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 archiveSize = 0;
+    qint64 archiveModified = 0;
+    stream >> magic >> version >> archiveSize >> archiveModified;
+    if (magic != IndexMagic || version != IndexVersion || archiveSize != dataSize
+        || archiveModified != QFileInfo(archiveFile.fileName()).lastModified().toMSecsSinceEpoch()) {
+        return false;
+    }
+
+    qint32 count = 0;
+    stream >> count;
+    QVector<ArchiveMember> loaded;
+    loaded.reserve(count);
+    for (qint32 i = 0; i < count; ++i) {
+        ArchiveMember member;
+        stream >> member.name >> member.offset >> member.size >> member.compressedSize >> member.method;
+        if (member.offset + member.compressedSize > dataSize) {
+            return false;
+        }
+        loaded.append(member);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    members = loaded;
+    return true;
+}
+
+void ArchiveImageSource::saveIndex(const QString &indexPath) const
+{
+    // 归档所在目录只读时不保存索引，下次打开再扫描一遍
+    QFile file(indexPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream << IndexMagic << IndexVersion << dataSize
+           << QFileInfo(archiveFile.fileName()).lastModified().toMSecsSinceEpoch()
+           << qint32(members.size());
+    for (const ArchiveMember &member : members) {
+        stream << member.name << member.offset << member.size << member.compressedSize << member.method;
+    }
+}
+
+QString ArchiveImageSource::entryStamp(const QString &entry) const
+{
+    // 成员本身没有可靠的修改时间，用归档的修改时间加上成员的位置和大小
+    auto it = memberIndex.constFind(entry);
+    if (it == memberIndex.constEnd()) {
+        return QString();
+    }
+    const ArchiveMember &member = members[it.value()];
+    const QDateTime modified = QFileInfo(archiveFile.fileName()).lastModified();
+    return QString("%1:%2:%3").arg(modified.toMSecsSinceEpoch()).arg(member.offset).arg(member.size);
+}
+
+QByteArray ArchiveImageSource::readEntry(const QString &entry) const
+{
+    auto it = memberIndex.constFind(entry);
+    if (it == memberIndex.constEnd()) {
+        return QByteArray();
+    }
+    const ArchiveMember &member = members[it.value()];
+    const char *memberData = reinterpret_cast<const char *>(data + member.offset);
+
+    if (member.method == 0) {
+        // 零拷贝：QByteArray 直接引用映射内存，归档在 ImageSource 生命周期内一直保持映射
+        return QByteArray::fromRawData(memberData, qsizetype(member.size));
+    }
+
+#ifdef QTLABELER_HAVE_ZLIB
+    QByteArray out(qsizetype(member.size), Qt::Uninitialized);
+    z_stream stream = {};
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(memberData));
+    stream.avail_in = uInt(member.compressedSize);
+    stream.next_out = reinterpret_cast<Bytef *>(out.data());
+    stream.avail_out = uInt(member.size);
+    // 负的窗口位数表示没有 zlib 头的原始 deflate 数据
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return QByteArray();
+    }
+    int result = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    return result == Z_STREAM_END ? out : QByteArray();
+#else
+    return QByteArray();
+#endif
+}
+
+std::unique_ptr<QIODevice> ArchiveImageSource::openEntry(const QString &entry) const
+{
+    if (!memberIndex.contains(entry)) {
+        return nullptr;
+    }
+    // 未压缩的条目仍然直接引用映射内存；压缩的条目只能整体解压
+    auto buffer = std::make_unique<QBuffer>();
+    buffer->setData(readEntry(entry));
+    buffer->open(QIODevice::ReadOnly);
+    return buffer;
+}
+
+} // namespace
+
+QImage ImageSource::readImage(const QString &entry) const
+{
+    return QImage::fromData(readEntry(entry));
+}
+
+bool ImageSource::isImageName(const QString &name)
+{
+    static const QStringList suffixes = {"jpg", "jpeg", "png", "bmp", "tif", "tiff"};
+    return suffixes.contains(QFileInfo(name).suffix(), Qt::CaseInsensitive);
+}
+
+std::unique_ptr<ImageSource> ImageSource::open(const QString &path, QString *errorString)
+{
+    QString error;
+    QFileInfo info(path);
+    if (info.isDir()) {
+        return std::make_unique<DirectoryImageSource>(path);
+    }
+
+    const QString suffix = info.suffix().toLower();
+    if (suffix == "tar" || suffix == "zip") {
+        auto archive = std::make_unique<ArchiveImageSource>();
+        if (archive->open(path, &error)) {
+            return archive;
+        }
+    } else {
+        error = "不支持的数据集格式: " + path;
+    }
+
+    if (errorString) {
+        *errorString = error;
+    }
+    return nullptr;
+}
@@ -0,0 +1,45 @@
+/* *************************************************************** */
+/* imagesource.h                           */
+/* *************************************************************** */
+#ifndef IMAGESOURCE_H
+#define IMAGESOURCE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QImage>
+#include <QIODevice>
+#include <memory>
+
+// 图片数据集的来源：普通文件夹，或者 tar/zip 归档。
+// 条目名是相对于数据集根的路径。读取接口都是 const 且线程安全，可在工作线程中并发调用。
+class ImageSource
+{
+public:
+    virtual ~ImageSource() = default;
+
+    // 打开文件夹或归档，失败时返回空指针并在 errorString 中给出原因
+    static std::unique_ptr<ImageSource> open(const QString& path, QString* errorString = nullptr);
+
+    // 数据集的位置（文件夹或归档文件路径）
+    virtual QString location() const = 0;
+    // 按名称排序的图片条目
+    virtual QStringList entries() const = 0;
+    // 条目的编码后数据。归档中未压缩的条目直接引用内存映射，不复制。
+    virtual QByteArray readEntry(const QString& entry) const = 0;
+    // 以只读方式打开条目，按需读取（例如只读图片头部）。文件夹返回 QFile，
+    // 归档返回引用映射内存的 QBuffer。条目不存在时返回空指针。
+    virtual std::unique_ptr<QIODevice> openEntry(const QString& entry) const = 0;
+    // 条目对应的 sidecar 标注文件路径。归档的标注写到旁边的 <归档>.annotations 目录中。
+    virtual QString annotationPath(const QString& entry) const = 0;
+    // 条目内容的版本标识（修改时间和大小），内容变化后随之改变，用于校验缓存
+    virtual QString entryStamp(const QString& entry) const = 0;
+    // 数据集级别缓存文件（如图片哈希）的路径，name 区分不同的缓存
+    virtual QString cachePath(const QString& name) const = 0;
+
+    QImage readImage(const QString& entry) const;
+
+    static bool isImageName(const QString& name);
+};
+
+#endif // IMAGESOURCE_H
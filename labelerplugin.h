@@ -0,0 +1,32 @@
+/* *************************************************************** */
+/* labelerplugin.h                         */
+/* *************************************************************** */
+#ifndef LABELERPLUGIN_H
+#define LABELERPLUGIN_H
+
+#include <QtPlugin>
+#include <QImage>
+#include <QList>
+#include <QString>
+#include "annotationfile.h"
+
+// 预标注插件接口。插件编译为共享库，通过 QPluginLoader 加载。
+// annotate 会在预标注线程池中被并发调用，实现必须是线程安全的。
+class LabelerPlugin
+{
+public:
+    virtual ~LabelerPlugin() = default;
+
+    virtual QString name() const = 0;
+    // 一次 annotate 调用最多传入的图片数
+    virtual int preferredBatchSize() const { return 4; }
+    // 为一批图片生成标注，返回的列表与 images 一一对应。
+    // 形状使用原图像素坐标，shapeType 为 "polygon" 或 "rectangle"（两个角点）。
+    // 无法解码的图片以空 QImage 传入，对应位置返回空列表即可。
+    virtual QList<QList<AnnotationShape>> annotate(const QList<QImage>& images) = 0;
+};
+
+#define LabelerPlugin_iid "org.qtlabeler.LabelerPlugin/1.0"
+Q_DECLARE_INTERFACE(LabelerPlugin, LabelerPlugin_iid)
+
+#endif // LABELERPLUGIN_H
@@ -0,0 +1,217 @@
+/* *************************************************************** */
+/* magicwand.cpp                           */
+/* *************************************************************** */
+#include "magicwand.h"
+#include "pointdecimator.h"
+
+#include <QImage>
+#include <QVector>
+#include <cstdlib>
+
+namespace {
+
+// 掩码取值
+const uchar Unmatched = 0;
+const uchar Matched = 1;
+const uchar Filled = 2;
+
+const qreal ContourTolerance = 1.0; // 轮廓简化容差（像素）
+
+// 8 邻域方向，按顺时针排列（y 轴向下）
+const int DirX[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+const int DirY[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+int directionIndex(int dx, int dy)
+{
+    for (int i = 0; i < 8; ++i) {
+        if (DirX[i] == dx && DirY[i] == dy) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+class RegionGrower
+{
+public:
+    RegionGrower(const quint32 *pixels, int width, int height, qsizetype stride, quint32 seedColor, int tolerance)
+        : pixels(pixels), width(width), height(height), stride(stride)
+        , seedRed((seedColor >> 16) & 0xff), seedGreen((seedColor >> 8) & 0xff), seedBlue(seedColor & 0xff)
+        , tolerance(tolerance)
+        , mask(qsizetype(width) * height, Unmatched)
+        , rowReady(height, false)
+    {
+    }
+
+    uchar *row(int y)
+    {
+        uchar *maskRow = mask.data() + qsizetype(y) * width;
+        if (!rowReady[y]) {
+            computeRow(pixels + qsizetype(y) * stride, maskRow);
+            rowReady[y] = true;
+        }
+        return maskRow;
+    }
+
+    bool isFilled(int x, int y) const
+    {
+        return x >= 0 && y >= 0 && x < width && y < height && mask[qsizetype(y) * width + x] == Filled;
+    }
+
+    int width;
+    int height;
+
+private:
+    // 整行一次性做颜色距离判断。循环体没有分支和跨迭代依赖，编译器可以自动向量化。
+    void computeRow(const quint32 *source, uchar *out) const
+    {
+        for (int x = 0; x < width; ++x) {
+            const quint32 pixel = source[x];
+            const int dr = std::abs(int((pixel >> 16) & 0xff) - seedRed);
+            const int dg = std::abs(int((pixel >> 8) & 0xff) - seedGreen);
+            const int db = std::abs(int(pixel & 0xff) - seedBlue);
+            out[x] = uchar((dr <= tolerance) & (dg <= tolerance) & (db <= tolerance));
+        }
+    }
+
+    const quint32 *pixels;
+    qsizetype stride;
+    int seedRed;
+    int seedGreen;
+    int seedBlue;
+    int tolerance;
+    QVector<uchar> mask;
+    QVector<bool> rowReady;
+};
+
+// 扫描线填充：每次填满一整段水平区间，再把上下两行中相邻的可填区间入栈。
+// topLeft 返回区域中最上面一行的最左像素，作为轮廓跟踪的起点。
+bool scanlineFill(RegionGrower &grower, const QPoint &seed, const std::function<bool()> &cancelled, QPoint *topLeft)
+{
+    *topLeft = seed;
+    QVector<QPoint> stack;
+    stack.append(seed);
+    int processed = 0;
+    while (!stack.isEmpty()) {
+        if (cancelled && (++processed & 0x3ff) == 0 && cancelled()) {
+            return false;
+        }
+        const QPoint point = stack.takeLast();
+        uchar *line = grower.row(point.y());
+        if (line[point.x()] != Matched) {
+            continue;
+        }
+
+        int left = point.x();
+        while (left > 0 && line[left - 1] == Matched) {
+            --left;
+        }
+        int right = point.x();
+        while (right < grower.width - 1 && line[right + 1] == Matched) {
+            ++right;
+        }
+        for (int x = left; x <= right; ++x) {
+            line[x] = Filled;
+        }
+        if (point.y() < topLeft->y() || (point.y() == topLeft->y() && left < topLeft->x())) {
+            *topLeft = QPoint(left, point.y());
+        }
+
+        for (int dy = -1; dy <= 1; dy += 2) {
+            const int y = point.y() + dy;
+            if (y < 0 || y >= grower.height) {
+                continue;
+            }
+            const uchar *neighbour = grower.row(y);
+            bool inSpan = false;
+            for (int x = left; x <= right; ++x) {
+                if (neighbour[x] == Matched) {
+                    if (!inSpan) {
+                        stack.append(QPoint(x, y));
+                        inSpan = true;
+                    }
+                } else {
+                    inSpan = false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Moore 邻域轮廓跟踪，从最上最左的区域像素出发顺时针走一圈，返回像素中心坐标
+QPolygonF traceContour(const RegionGrower &grower, const QPoint &start)
+{
+    QPolygonF contour;
+    contour << QPointF(start.x() + 0.5, start.y() + 0.5);
+
+    QPoint current = start;
+    int backtrack = 4; // 起点左侧一定不在区域内
+    int firstMove = -1;
+    const int maxSteps = 4 * grower.width * grower.height + 8;
+    for (int step = 0; step < maxSteps; ++step) {
+        int move = -1;
+        for (int k = 1; k <= 8; ++k) {
+            int d = (backtrack + k) % 8;
+            if (grower.isFilled(current.x() + DirX[d], current.y() + DirY[d])) {
+                move = d;
+                break;
+            }
+        }
+        if (move < 0) {
+            break; // 孤立像素
+        }
+        if (current == start) {
+            // Jacob 停止条件：以相同方向再次离开起点时轮廓闭合
+            if (move == firstMove) {
+                break;
+            }
+            if (firstMove < 0) {
+                firstMove = move;
+            }
+        }
+
+        // 新的回溯方向：移动前最后一个检查过的背景像素，相对于新位置
+        const int previous = (move + 7) % 8;
+        const QPoint next(current.x() + DirX[move], current.y() + DirY[move]);
+        backtrack = directionIndex(current.x() + DirX[previous] - next.x(), current.y() + DirY[previous] - next.y());
+        current = next;
+        if (current == start && firstMove >= 0) {
+            continue;
+        }
+        contour << QPointF(current.x() + 0.5, current.y() + 0.5);
+    }
+    return contour;
+}
+
+} // namespace
+
+QPolygonF MagicWand::segmentPixels(const quint32 *pixels, int width, int height, qsizetype stride,
+                                   const QPoint &seed, int tolerance, const std::function<bool()> &cancelled)
+{
+    if (seed.x() < 0 || seed.y() < 0 || seed.x() >= width || seed.y() >= height) {
+        return QPolygonF();
+    }
+
+    RegionGrower grower(pixels, width, height, stride, pixels[qsizetype(seed.y()) * stride + seed.x()], tolerance);
+    QPoint start;
+    if (!scanlineFill(grower, seed, cancelled, &start)) {
+        return QPolygonF();
+    }
+
+    QPolygonF contour = traceContour(grower, start);
+    if (contour.size() < 3) {
+        return QPolygonF();
+    }
+    return StreamingDecimator::simplify(contour, ContourTolerance);
+}
+
+QPolygonF MagicWand::segment(const QImage &image, const QPoint &seed, int tolerance,
+                             const std::function<bool()> &cancelled)
+{
+    if (image.format() != QImage::Format_RGB32 && image.format() != QImage::Format_ARGB32) {
+        return segment(image.convertToFormat(QImage::Format_RGB32), seed, tolerance, cancelled);
+    }
+    return segmentPixels(reinterpret_cast<const quint32 *>(image.constBits()), image.width(), image.height(),
+                         image.bytesPerLine() / 4, seed, tolerance, cancelled);
+}
@@ -0,0 +1,29 @@
+/* *************************************************************** */
+/* magicwand.h                             */
+/* *************************************************************** */
+#ifndef MAGICWAND_H
+#define MAGICWAND_H
+
+#include <QPolygonF>
+#include <QPoint>
+#include <functional>
+
+class QImage;
+
+// 魔棒分割：从种子点按颜色容差做扫描线区域生长，提取区域外轮廓并简化成多边形。
+// 只读取传入的图像，可以在工作线程中运行。
+class MagicWand
+{
+public:
+    // image 必须是 Format_RGB32 / ARGB32。tolerance 是每个颜色通道允许的最大差值。
+    // cancelled 返回 true 时尽快结束并返回空多边形。
+    static QPolygonF segment(const QImage& image, const QPoint& seed, int tolerance,
+                             const std::function<bool()>& cancelled = {});
+
+    // 与 segment 相同，直接处理 32 位像素缓冲区；stride 以像素为单位
+    static QPolygonF segmentPixels(const quint32* pixels, int width, int height, qsizetype stride,
+                                   const QPoint& seed, int tolerance,
+                                   const std::function<bool()>& cancelled = {});
+};
+
+#endif // MAGICWAND_H
@@ -8,6 +8,11 @@
 #include "canvasscene.h"
 #include "polygonitem.h"
 #include "rectangleitem.h"
+#include "annotationfile.h"
+#include "datasetreportdialog.h"
+#include "overlapdetector.h"
+#include "imagesource.h"
+#include "preannotationscheduler.h"
 
 #include <QFileDialog>
 #include <QDir>
@@ -18,6 +23,30 @@
 #include <QBuffer>
 #include <QFileInfo>
 #include <QInputDialog>
+#include <QProgressDialog>
+#include <QMessageBox>
+#include <QtConcurrent>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+// 数据集目录的变化往往成批到达（拷贝一批帧、外部工具先写临时文件再改名），合并后再处理
+const int DatasetChangeDelayMs = 300;
+
+// 文件的修改时间和大小，文件不存在时为空
+QString fileStamp(const QString &path)
+{
+    QFileInfo info(path);
+    if (!info.exists()) {
+        return QString();
+    }
+    return QString("%1:%2").arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size());
+}
+
+} // namespace
 
 
 MainWindow::MainWindow(QWidget *parent)
@@ -43,13 +72,41 @@ MainWindow::MainWindow(QWidget *parent)
     connect(scene, &CanvasScene::polygonFinished, this, &MainWindow::handlePolygonFinished);
     connect(scene, &CanvasScene::rectangleFinished, this, &MainWindow::handleRectangleFinished);
     connect(scene, &QGraphicsScene::selectionChanged, this, &MainWindow::handleSelectionChanged);
+    connect(scene, &CanvasScene::magicWandToleranceChanged, this, [this](int tolerance) {
+        statusBar()->showMessage(QString("魔棒容差: %1").arg(tolerance), 3000);
+    });
 
     ui->shapeListWidget->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(ui->shapeListWidget, &QListWidget::customContextMenuRequested, this, &MainWindow::on_shapeListWidget_customContextMenuRequested);
+
+    validationWatcher = new QFutureWatcher<DatasetStatistics>(this);
+    connect(validationWatcher, &QFutureWatcherBase::finished, this, &MainWindow::handleValidationFinished);
+    overlapWatcher = new QFutureWatcher<QList<DatasetIssue>>(this);
+    connect(overlapWatcher, &QFutureWatcherBase::finished, this, &MainWindow::handleOverlapSearchFinished);
+    hashWatcher = new QFutureWatcher<HashRecord>(this);
+    connect(hashWatcher, &QFutureWatcherBase::finished, this, &MainWindow::handleHashingFinished);
+    trackingWatcher = new QFutureWatcher<TrackedShape>(this);
+    connect(trackingWatcher, &QFutureWatcherBase::finished, this, &MainWindow::handleTrackingFinished);
+
+    updateDisplayControls();
+
+    datasetWatcher = new QFileSystemWatcher(this);
+    datasetChangeTimer = new QTimer(this);
+    datasetChangeTimer->setSingleShot(true);
+    datasetChangeTimer->setInterval(DatasetChangeDelayMs);
+    connect(datasetWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::handleWatchedPathChanged);
+    connect(datasetWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::handleWatchedPathChanged);
+    connect(datasetChangeTimer, &QTimer::timeout, this, &MainWindow::handleDatasetChanged);
+    connect(scene, &CanvasScene::annotationEdited, this, [this]() { annotationsDirty = true; });
+
+    preAnnotation = new PreAnnotationScheduler(this);
+    connect(preAnnotation, &PreAnnotationScheduler::resultReady, this, &MainWindow::handlePreAnnotationReady);
 }
 
 MainWindow::~MainWindow()
 {
+    // 后台任务读取 imageSource，它作为成员会先于子对象被销毁
+    stopDatasetJobs();
     delete ui;
 }
 
@@ -96,64 +153,141 @@ void MainWindow::on_actionOpen_Folder_triggered()
     }
 }
 
+void MainWindow::on_actionOpen_Archive_triggered()
+{
+    QString path = QFileDialog::getOpenFileName(this, "打开归档", "", "图片归档 (*.tar *.zip)");
+    if (!path.isEmpty()) {
+        loadDirectory(path);
+    }
+}
+
 void MainWindow::loadDirectory(const QString &path)
 {
+    QString error;
+    std::unique_ptr<ImageSource> source = ImageSource::open(path, &error);
+    if (!source) {
+        statusBar()->showMessage("错误：无法打开数据集 " + error, 3000);
+        return;
+    }
+
+    // 后台任务直接读取旧的数据源，替换之前先让它们结束
+    stopDatasetJobs();
+    scene->clearAllItems();
+    ui->shapeListWidget->clear();
+
+    imageSource = std::move(source);
+    ++datasetGeneration;
     currentDirectory = path;
-    QDir dir(path);
-    QStringList filters;
-    filters << "*.jpg" << "*.jpeg" << "*.png" << "*.bmp";
-    imageFiles = dir.entryList(filters, QDir::Files | QDir::NoDotAndDotDot);
+    imageFiles = imageSource->entries();
+    currentFileIndex = -1;
+    preAnnotation->setSource(imageSource.get(), imageFiles);
+    duplicateGroups.clear();
+    duplicateGroupOf.clear();
 
     ui->fileListWidget->clear();
     ui->fileListWidget->addItems(imageFiles);
 
+    // 只有文件夹会增删条目；归档只监视标注目录中当前图片的 sidecar
+    if (!datasetWatcher->files().isEmpty()) {
+        datasetWatcher->removePaths(datasetWatcher->files());
+    }
+    if (!datasetWatcher->directories().isEmpty()) {
+        datasetWatcher->removePaths(datasetWatcher->directories());
+    }
+    watchedCurrentPaths.clear();
+    if (QFileInfo(imageSource->location()).isDir()) {
+        datasetWatcher->addPath(imageSource->location());
+    }
+
     if (!imageFiles.isEmpty()) {
         currentFileIndex = 0;
         ui->fileListWidget->setCurrentRow(currentFileIndex);
-        loadImage(QDir(currentDirectory).filePath(imageFiles[currentFileIndex]));
+        loadImage(imageFiles[currentFileIndex]);
     }
 }
 
-void MainWindow::loadImage(const QString &imagePath)
+void MainWindow::stopDatasetJobs()
 {
-    QList<QGraphicsItem*> items = scene->items();
-    for(QGraphicsItem* item : items){
-        scene->removeItem(item);
-        delete item;
-    }
+    validationWatcher->cancel();
+    validationWatcher->waitForFinished();
+    overlapWatcher->cancel();
+    overlapWatcher->waitForFinished();
+    hashWatcher->cancel();
+    hashWatcher->waitForFinished();
+    entriesFuture.waitForFinished();
+    preAnnotation->setSource(nullptr, {});
+}
+
+void MainWindow::loadImage(const QString &entry)
+{
+    ++trackingGeneration;
+    trackingWatcher->cancel();
+    preAnnotationPending = false;
+    annotationsDirty = false;
+    annotationConflict = false;
+
+    // 在工作线程中解析标注文件，和下面的图片解码同时进行
+    QString jsonPath = imageSource->annotationPath(entry);
+    QFuture<AnnotationFile> annotationFuture = QtConcurrent::run([jsonPath]() {
+        AnnotationFile annotation;
+        readAnnotationFile(jsonPath, &annotation);
+        return annotation;
+    });
+
+    scene->clearAllItems();
     ui->shapeListWidget->clear();
 
-    QPixmap pixmap(imagePath);
-    if (pixmap.isNull()) {
-        statusBar()->showMessage("错误：无法加载图片 " + imagePath, 3000);
+    // 解码成 QImage 保留原始位深，16 位图片不经过 QPixmap 量化
+    QImage image = imageSource->readImage(entry);
+    if (image.isNull()) {
+        statusBar()->showMessage("错误：无法加载图片 " + entry, 3000);
         return;
     }
     
-    scene->addPixmap(pixmap);
-    scene->setSceneRect(pixmap.rect());
+    scene->setImage(image);
+    scene->setSceneRect(image.rect());
+    updateDisplayControls();
     view->fitInView(scene->sceneRect(), Qt::KeepAspectRatio);
-    statusBar()->showMessage("已加载图片: " + imagePath, 3000);
+    statusBar()->showMessage("已加载图片: " + entry, 3000);
 
-    QString jsonPath = imagePath.left(imagePath.lastIndexOf('.')) + ".json";
-    loadAnnotations(jsonPath);
+    const AnnotationFile annotation = annotationFuture.result();
+    loadAnnotations(annotation);
+    currentImageStamp = imageSource->entryStamp(entry);
+    currentSidecarStamp = fileStamp(jsonPath);
+    watchCurrentFiles(entry);
+
+    if (preAnnotation->hasPlugin()) {
+        // 只给还没有标注的图片插入预标注，结果还没算完时等 resultReady
+        QList<AnnotationShape> shapes;
+        if (annotation.shapes.isEmpty()) {
+            if (preAnnotation->result(entry, &shapes)) {
+                scene->addSuggestions(createAnnotationItems(shapes));
+                updateShapeList();
+            } else {
+                preAnnotationPending = true;
+            }
+        }
+        // 调用方已经把 currentFileIndex 设为该条目
+        preAnnotation->prefetch(currentFileIndex);
+    }
 }
 
 
 void MainWindow::on_fileListWidget_itemClicked(QListWidgetItem *item)
 {
     currentFileIndex = ui->fileListWidget->row(item);
-    loadImage(QDir(currentDirectory).filePath(imageFiles[currentFileIndex]));
+    loadImage(imageFiles[currentFileIndex]);
 }
 
 
 void MainWindow::on_actionSave_triggered()
 {
     if (currentFileIndex != -1) {
-        saveAnnotations(QDir(currentDirectory).filePath(imageFiles[currentFileIndex]));
+        saveAnnotations(imageFiles[currentFileIndex]);
     }
 }
 
-void MainWindow::saveAnnotations(const QString& imagePath)
+void MainWindow::saveAnnotations(const QString& entry)
 {
     QJsonObject rootObj;
     rootObj["version"] = "5.4.1";
@@ -161,6 +295,10 @@ void MainWindow::saveAnnotations(const QString& imagePath)
 
     QJsonArray shapesArray;
     for (QGraphicsItem *item : scene->items()) {
+        // 未确认的建议不写入文件
+        if (CanvasScene::isSuggestion(item)) {
+            continue;
+        }
         if (auto polygonItem = dynamic_cast<PolygonItem*>(item)) {
             QJsonObject shapeObj;
             shapeObj["label"] = polygonItem->getLabel();
@@ -194,89 +332,499 @@ void MainWindow::saveAnnotations(const QString& imagePath)
     }
     rootObj["shapes"] = shapesArray;
 
-    rootObj["imagePath"] = QFileInfo(imagePath).fileName();
+    rootObj["imagePath"] = QFileInfo(entry).fileName();
     
-    QPixmap pixmap(imagePath);
-    rootObj["imageHeight"] = pixmap.height();
-    rootObj["imageWidth"] = pixmap.width();
+    QImage image = imageSource->readImage(entry);
+    rootObj["imageHeight"] = image.height();
+    rootObj["imageWidth"] = image.width();
 
+    // PNG 支持 16 位，嵌入的图片数据保持原始位深
     QByteArray byteArray;
     QBuffer buffer(&byteArray);
     buffer.open(QIODevice::WriteOnly);
-    pixmap.save(&buffer, "PNG"); 
+    image.save(&buffer, "PNG"); 
     rootObj["imageData"] = QString::fromLatin1(byteArray.toBase64());
     
     QJsonDocument doc(rootObj);
-    QString savePath = imagePath.left(imagePath.lastIndexOf('.')) + ".json";
+    QString savePath = imageSource->annotationPath(entry);
+    // 打开之后 sidecar 被外部改写过：覆盖前确认，否则外部的修改会被悄悄丢掉
+    const bool isCurrentEntry = currentFileIndex != -1 && imageFiles[currentFileIndex] == entry;
+    if (isCurrentEntry && (annotationConflict || fileStamp(savePath) != currentSidecarStamp)
+        && QMessageBox::question(this, "保存标注", "标注文件在打开之后已被其他程序修改，要用当前的标注覆盖它吗？")
+               != QMessageBox::Yes) {
+        statusBar()->showMessage("未保存：标注文件已在外部修改。", 3000);
+        return;
+    }
+    // 归档数据集的标注目录在第一次保存时创建
+    QDir().mkpath(QFileInfo(savePath).absolutePath());
     QFile file(savePath);
     if (file.open(QIODevice::WriteOnly)) {
         file.write(doc.toJson());
         file.close();
+        // 自己写入的变化不当作外部修改。文件夹数据集的 sidecar 写在被监视的目录里，
+        // 记下写入后的状态，过滤掉由此产生的监视事件。
+        ownSidecarPath = QFileInfo(savePath).absoluteFilePath();
+        ownSidecarStamp = fileStamp(savePath);
+        ownSidecarDirModified = QFileInfo(QFileInfo(savePath).absolutePath()).lastModified();
+        if (isCurrentEntry) {
+            currentSidecarStamp = fileStamp(savePath);
+            annotationsDirty = false;
+            annotationConflict = false;
+            watchCurrentFiles(entry);
+        }
         statusBar()->showMessage("标注已保存: " + savePath, 3000);
     } else {
         statusBar()->showMessage("错误：无法保存标注文件 " + savePath, 3000);
     }
 }
 
-void MainWindow::loadAnnotations(const QString &jsonPath)
+void MainWindow::loadAnnotations(const AnnotationFile &annotation)
 {
-    QFile file(jsonPath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        return;
-    }
-    
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    QJsonObject rootObj = doc.object();
-    QJsonArray shapesArray = rootObj["shapes"].toArray();
-
-    for (const QJsonValue &value : shapesArray) {
-        QJsonObject shapeObj = value.toObject();
-        if (shapeObj["shape_type"] == "polygon") {
-            QPolygonF polygon;
-            QJsonArray pointsArray = shapeObj["points"].toArray();
-            for (const QJsonValue &pointValue : pointsArray) {
-                QJsonArray pointArray = pointValue.toArray();
-                polygon << QPointF(pointArray[0].toDouble(), pointArray[1].toDouble());
-            }
-            
-            auto polygonItem = new PolygonItem(polygon);
-            polygonItem->setLabel(shapeObj["label"].toString());
+    scene->addItemsBulk(createAnnotationItems(annotation.shapes));
+    updateShapeList();
+}
+
+QList<QGraphicsItem*> MainWindow::createAnnotationItems(const QList<AnnotationShape> &shapes) const
+{
+    QList<QGraphicsItem*> items;
+    items.reserve(shapes.size());
+    for (const AnnotationShape &shape : shapes) {
+        if (shape.shapeType == "polygon") {
+            auto polygonItem = new PolygonItem(shape.points);
+            polygonItem->setLabel(shape.label);
             polygonItem->setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemSendsGeometryChanges);
-            scene->addItem(polygonItem);
-        } else if (shapeObj["shape_type"] == "rectangle") {
-            QJsonArray pointsArray = shapeObj["points"].toArray();
-            QPointF topLeft(pointsArray[0].toArray()[0].toDouble(), pointsArray[0].toArray()[1].toDouble());
-            QPointF bottomRight(pointsArray[1].toArray()[0].toDouble(), pointsArray[1].toArray()[1].toDouble());
-            QRectF rect(topLeft, bottomRight);
+            items.append(polygonItem);
+        } else if (shape.shapeType == "rectangle") {
+            QRectF rect(shape.points.value(0), shape.points.value(1));
 
             auto rectangleItem = new RectangleItem(rect);
-            rectangleItem->setLabel(shapeObj["label"].toString());
-            rectangleItem->setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsMovable);
-            scene->addItem(rectangleItem);
+            rectangleItem->setLabel(shape.label);
+            rectangleItem->setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemSendsGeometryChanges);
+            items.append(rectangleItem);
         }
     }
-    updateShapeList();
+    return items;
 }
 
 
 void MainWindow::on_actionNext_Image_triggered()
 {
-    if (currentFileIndex < imageFiles.size() - 1) {
-        currentFileIndex++;
+    goToImage(1);
+}
+
+void MainWindow::on_actionPrev_Image_triggered()
+{
+    goToImage(-1);
+}
+
+void MainWindow::goToImage(int step)
+{
+    // 跳过文件列表中隐藏的重复图片
+    int index = currentFileIndex + step;
+    while (index >= 0 && index < imageFiles.size() && ui->fileListWidget->item(index)->isHidden()) {
+        index += step;
+    }
+    if (index >= 0 && index < imageFiles.size()) {
+        currentFileIndex = index;
         ui->fileListWidget->setCurrentRow(currentFileIndex);
-        loadImage(QDir(currentDirectory).filePath(imageFiles[currentFileIndex]));
+        loadImage(imageFiles[currentFileIndex]);
     }
 }
 
-void MainWindow::on_actionPrev_Image_triggered()
+void MainWindow::watchCurrentFiles(const QString &entry)
 {
-    if (currentFileIndex > 0) {
-        currentFileIndex--;
+    // sidecar 不存在时监视它所在的目录，等外部工具创建它
+    const QString sidecar = imageSource->annotationPath(entry);
+    QStringList paths;
+    if (QFileInfo::exists(sidecar)) {
+        paths << sidecar;
+    }
+    const QString sidecarDir = QFileInfo(sidecar).absolutePath();
+    if (QFileInfo::exists(sidecarDir) && !datasetWatcher->directories().contains(sidecarDir)) {
+        paths << sidecarDir;
+    }
+
+    if (!watchedCurrentPaths.isEmpty()) {
+        datasetWatcher->removePaths(watchedCurrentPaths);
+    }
+    // 原子替换（写临时文件后改名）会让原来的监视失效，每次都重新添加
+    const QStringList failed = paths.isEmpty() ? QStringList() : datasetWatcher->addPaths(paths);
+    watchedCurrentPaths.clear();
+    for (const QString &path : paths) {
+        if (!failed.contains(path)) {
+            watchedCurrentPaths << path;
+        }
+    }
+}
+
+void MainWindow::handleWatchedPathChanged(const QString &path)
+{
+    if (!ownSidecarPath.isEmpty()) {
+        // sidecar 本身：内容与写入后一致
+        if (path == ownSidecarPath && fileStamp(path) == ownSidecarStamp) {
+            return;
+        }
+        // 所在目录：写入后目录没有再新增、删除或改名
+        if (path == QFileInfo(ownSidecarPath).absolutePath()
+            && QFileInfo(path).lastModified() == ownSidecarDirModified) {
+            return;
+        }
+    }
+    datasetChangeTimer->start();
+}
+
+void MainWindow::handleDatasetChanged()
+{
+    if (!imageSource) {
+        return;
+    }
+    if (!QFileInfo(imageSource->location()).isDir()) {
+        checkCurrentEntryChanged();
+        return;
+    }
+    if (entriesFuture.isRunning()) {
+        // 上一次列表还没完成，等它结束后再处理这次变化
+        datasetChangeTimer->start();
+        return;
+    }
+
+    // 大文件夹的列表和排序放在工作线程中，GUI 线程只做差异合并
+    const ImageSource *source = imageSource.get();
+    const int generation = datasetGeneration;
+    entriesFuture = QtConcurrent::run([source]() { return source->entries(); });
+    entriesFuture.then(this, [this, generation](const QStringList &fresh) {
+        if (generation != datasetGeneration) {
+            return;
+        }
+        refreshEntries(fresh);
+        checkCurrentEntryChanged();
+    });
+}
+
+void MainWindow::checkCurrentEntryChanged()
+{
+    if (currentFileIndex == -1) {
+        return;
+    }
+
+    const QString entry = imageFiles[currentFileIndex];
+    const QString imageStamp = imageSource->entryStamp(entry);
+    const QString sidecarStamp = fileStamp(imageSource->annotationPath(entry));
+    const bool imageChanged = imageStamp != currentImageStamp;
+    const bool sidecarChanged = sidecarStamp != currentSidecarStamp;
+    if (imageChanged) {
+        // 缓存的预标注是按旧图片算的，不论这次是否重新加载都要丢弃
+        preAnnotation->invalidate({entry});
+        if (preAnnotation->hasPlugin()) {
+            preAnnotation->prefetch(currentFileIndex);
+        }
+    }
+    if (imageChanged || sidecarChanged) {
+        // 正在绘制的形状也算未保存的修改：重新加载会删除场景仍在使用的item
+        if (annotationsDirty || scene->isDrawing()) {
+            // 图片的变化记下后不再提示；sidecar 保留打开时的状态，保存时据此确认是否覆盖
+            currentImageStamp = imageStamp;
+            if (sidecarChanged && !annotationConflict) {
+                annotationConflict = true;
+                statusBar()->showMessage("标注文件已在外部修改。当前有未保存的修改，未重新加载，保存时会确认是否覆盖。", 5000);
+            } else if (imageChanged) {
+                statusBar()->showMessage("图片已在外部修改。当前有未保存的修改，未重新加载。", 5000);
+            }
+        } else if (imageChanged) {
+            loadImage(entry);
+            statusBar()->showMessage("图片已在外部修改，已重新加载: " + entry, 3000);
+            return;
+        } else {
+            reloadAnnotations(entry);
+        }
+    }
+    watchCurrentFiles(entry);
+}
+
+void MainWindow::refreshEntries(const QStringList &fresh)
+{
+    if (fresh == imageFiles) {
+        return;
+    }
+
+    const QString currentEntry = currentFileIndex != -1 ? imageFiles[currentFileIndex] : QString();
+    const QSet<QString> freshSet(fresh.begin(), fresh.end());
+    const QSet<QString> oldSet(imageFiles.begin(), imageFiles.end());
+    QStringList removedEntries;
+
+    // 两个列表排序规则相同：先从后往前删除消失的条目，剩下的相对顺序与新列表一致，
+    // 再按新列表的位置插入新增的条目。只改动变化的行，不重建整个列表。
+    ui->fileListWidget->setUpdatesEnabled(false);
+    int removed = 0;
+    int inserted = 0;
+    for (int row = imageFiles.size() - 1; row >= 0; --row) {
+        if (!freshSet.contains(imageFiles[row])) {
+            removedEntries << imageFiles[row];
+            delete ui->fileListWidget->takeItem(row);
+            imageFiles.removeAt(row);
+            ++removed;
+        }
+    }
+    for (int row = 0; row < fresh.size(); ++row) {
+        if (!oldSet.contains(fresh[row])) {
+            ui->fileListWidget->insertItem(row, fresh[row]);
+            imageFiles.insert(row, fresh[row]);
+            ++inserted;
+        }
+    }
+    if (imageFiles != fresh) {
+        ui->fileListWidget->clear();
+        ui->fileListWidget->addItems(fresh);
+        imageFiles = fresh;
+    }
+    ui->fileListWidget->setUpdatesEnabled(true);
+    // 删除后又以同名加入的图片不能沿用旧的预标注结果
+    preAnnotation->setEntries(imageFiles);
+    preAnnotation->invalidate(removedEntries);
+
+    // 重复组中去掉已删除的图片
+    if (removed > 0 && !duplicateGroups.isEmpty()) {
+        for (QStringList &group : duplicateGroups) {
+            group.removeIf([&freshSet](const QString &entry) { return !freshSet.contains(entry); });
+        }
+        duplicateGroups.removeIf([](const QStringList &group) { return group.size() < 2; });
+        duplicateGroupOf.clear();
+        for (int group = 0; group < duplicateGroups.size(); ++group) {
+            for (const QString &entry : duplicateGroups[group]) {
+                duplicateGroupOf.insert(entry, group);
+            }
+        }
+    }
+    if (!duplicateGroups.isEmpty() || removed > 0) {
+        applyDuplicateMarks();
+    }
+
+    const int previousIndex = currentFileIndex;
+    currentFileIndex = imageFiles.indexOf(currentEntry);
+    if (currentFileIndex != -1) {
         ui->fileListWidget->setCurrentRow(currentFileIndex);
-        loadImage(QDir(currentDirectory).filePath(imageFiles[currentFileIndex]));
+        if (!removedEntries.isEmpty() && preAnnotation->hasPlugin()) {
+            // invalidate 作废了正在进行的批次，重新安排当前窗口
+            preAnnotation->prefetch(currentFileIndex);
+        }
+    } else if (!currentEntry.isEmpty()) {
+        // 当前图片被删除：打开原位置上的图片
+        if (imageFiles.isEmpty()) {
+            scene->clearAllItems();
+            ui->shapeListWidget->clear();
+        } else {
+            currentFileIndex = qMin(previousIndex, imageFiles.size() - 1);
+            ui->fileListWidget->setCurrentRow(currentFileIndex);
+            loadImage(imageFiles[currentFileIndex]);
+        }
+    }
+
+    statusBar()->showMessage(QString("文件列表已更新：新增 %1 张，移除 %2 张。").arg(inserted).arg(removed), 3000);
+}
+
+void MainWindow::reloadAnnotations(const QString &entry)
+{
+    // 保留未确认的建议，只替换来自 sidecar 的标注
+    for (QGraphicsItem *item : annotationItems()) {
+        scene->removeItem(item);
+        delete item;
+    }
+
+    const QString jsonPath = imageSource->annotationPath(entry);
+    AnnotationFile annotation;
+    readAnnotationFile(jsonPath, &annotation);
+    loadAnnotations(annotation);
+    currentSidecarStamp = fileStamp(jsonPath);
+    annotationsDirty = false;
+    annotationConflict = false;
+    statusBar()->showMessage("标注文件已在外部修改，已重新加载: " + entry, 3000);
+}
+
+void MainWindow::on_actionLoad_Plugin_triggered()
+{
+    QString path = QFileDialog::getOpenFileName(this, "加载预标注插件", QCoreApplication::applicationDirPath() + "/plugins",
+                                                "插件 (*.so *.dll *.dylib)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QString error;
+    if (!preAnnotation->loadPlugin(path, &error)) {
+        statusBar()->showMessage("错误：无法加载插件 " + error, 5000);
+        return;
+    }
+    statusBar()->showMessage("已加载预标注插件: " + preAnnotation->pluginName(), 3000);
+
+    if (currentFileIndex != -1) {
+        preAnnotationPending = annotationItems().isEmpty() && scene->suggestionItems().isEmpty();
+        preAnnotation->prefetch(currentFileIndex);
     }
 }
 
+void MainWindow::handlePreAnnotationReady(const QString &entry)
+{
+    if (!preAnnotationPending || currentFileIndex == -1 || imageFiles[currentFileIndex] != entry) {
+        return;
+    }
+    preAnnotationPending = false;
+
+    QList<AnnotationShape> shapes;
+    if (preAnnotation->result(entry, &shapes) && !shapes.isEmpty()) {
+        scene->addSuggestions(createAnnotationItems(shapes));
+        updateShapeList();
+        statusBar()->showMessage(QString("插入了 %1 个预标注建议。").arg(shapes.size()), 3000);
+    }
+}
+
+void MainWindow::updateDisplayControls()
+{
+    const bool highDepth = scene->hasHighDepthImage();
+    ui->dockWidgetDisplay->setEnabled(highDepth);
+    if (!highDepth) {
+        return;
+    }
+
+    const DisplayWindow window = scene->displayWindow();
+    const QSignalBlocker centerBlocker(ui->windowCenterSlider);
+    const QSignalBlocker widthBlocker(ui->windowWidthSlider);
+    const QSignalBlocker gammaBlocker(ui->gammaSpinBox);
+    ui->windowCenterSlider->setValue(qRound(window.center));
+    ui->windowWidthSlider->setValue(qRound(window.width));
+    ui->gammaSpinBox->setValue(window.gamma);
+}
+
+void MainWindow::applyDisplayControls()
+{
+    DisplayWindow window;
+    window.center = ui->windowCenterSlider->value();
+    window.width = ui->windowWidthSlider->value();
+    window.gamma = ui->gammaSpinBox->value();
+    scene->setDisplayWindow(window);
+    statusBar()->showMessage(QString("窗位 %1，窗宽 %2，gamma %3")
+                                 .arg(window.center).arg(window.width).arg(window.gamma, 0, 'f', 2), 2000);
+}
+
+void MainWindow::on_windowCenterSlider_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    applyDisplayControls();
+}
+
+void MainWindow::on_windowWidthSlider_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    applyDisplayControls();
+}
+
+void MainWindow::on_gammaSpinBox_valueChanged(double value)
+{
+    Q_UNUSED(value);
+    applyDisplayControls();
+}
+
+void MainWindow::on_autoWindowButton_clicked()
+{
+    DisplayWindow window = scene->automaticDisplayWindow();
+    window.gamma = ui->gammaSpinBox->value();
+    scene->setDisplayWindow(window);
+    updateDisplayControls();
+}
+
+void MainWindow::on_actionCarry_Forward_triggered()
+{
+    if (currentFileIndex < 0 || currentFileIndex >= imageFiles.size() - 1) {
+        return;
+    }
+
+    // 切换前记下当前帧的形状和图像，未确认的建议也一起带入。
+    // 两帧的 RGB32 转换都在工作线程中进行，这里只取 future。
+    const QList<AnnotationShape> shapes = annotationShapes(annotationItems() + scene->suggestionItems());
+    const QFuture<QImage> previousImage = scene->analysisImageFuture();
+    const int previousIndex = currentFileIndex;
+    goToImage(1);
+    if (currentFileIndex == previousIndex || shapes.isEmpty()) {
+        return;
+    }
+    // 与预标注一样，只给还没有标注的帧生成建议，避免在已有标注上叠一层重复的形状
+    if (!annotationItems().isEmpty()) {
+        statusBar()->showMessage("这一张已有标注，未带入上一张的标注。", 3000);
+        return;
+    }
+
+    const QFuture<QImage> nextImage = scene->analysisImageFuture();
+    statusBar()->showMessage(QString("正在跟踪 %1 个标注...").arg(shapes.size()), 0);
+    const int generation = trackingGeneration;
+
+    // 在工作线程中建立两帧的灰度金字塔，然后每个形状作为一个任务并行跟踪
+    QtConcurrent::run([previousImage, nextImage]() {
+        return qMakePair(TrackingFrame::build(previousImage.result()), TrackingFrame::build(nextImage.result()));
+    }).then(this, [this, generation, shapes](const QPair<TrackingFrame, TrackingFrame> &frames) {
+        if (generation != trackingGeneration) {
+            return;
+        }
+        if (frames.first.levels.isEmpty() || frames.second.levels.isEmpty()) {
+            statusBar()->clearMessage();
+            return;
+        }
+        trackingJobGeneration = generation;
+        trackingWatcher->setFuture(QtConcurrent::mapped(shapes, [frames](const AnnotationShape &shape) {
+            return TemplateTracker::track(frames.first, frames.second, shape);
+        }));
+    });
+}
+
+void MainWindow::handleTrackingFinished()
+{
+    // 取消不一定来得及阻止任务完成；跟踪开始后切换过图片的结果属于别的帧
+    if (trackingWatcher->isCanceled() || trackingJobGeneration != trackingGeneration) {
+        return;
+    }
+
+    // 低于该互相关的结果仍作为建议加入，只在状态栏提示
+    const double MinTrackingScore = 0.6;
+    QList<AnnotationShape> shapes;
+    int weakMatches = 0;
+    for (const TrackedShape &tracked : trackingWatcher->future().results()) {
+        shapes.append(tracked.shape);
+        if (tracked.score < MinTrackingScore) {
+            ++weakMatches;
+        }
+    }
+
+    scene->addSuggestions(createAnnotationItems(shapes));
+    updateShapeList();
+    statusBar()->showMessage(QString("已带入 %1 个建议标注（%2 个匹配度较低）。Ctrl+Enter 接受，Ctrl+Backspace 拒绝。")
+                                 .arg(shapes.size()).arg(weakMatches), 5000);
+}
+
+QList<QGraphicsItem*> MainWindow::targetSuggestions() const
+{
+    // 有选中的建议时只处理选中的，否则处理全部
+    QList<QGraphicsItem*> selected;
+    for (QGraphicsItem *item : scene->selectedItems()) {
+        if (CanvasScene::isSuggestion(item)) {
+            selected.append(item);
+        }
+    }
+    return selected.isEmpty() ? scene->suggestionItems() : selected;
+}
+
+void MainWindow::on_actionAccept_Suggestions_triggered()
+{
+    const QList<QGraphicsItem*> suggestions = targetSuggestions();
+    if (!suggestions.isEmpty()) {
+        annotationsDirty = true;
+    }
+    scene->acceptSuggestions(suggestions);
+    updateShapeList();
+}
+
+void MainWindow::on_actionReject_Suggestions_triggered()
+{
+    scene->rejectSuggestions(targetSuggestions());
+    updateShapeList();
+}
+
 void MainWindow::on_actionCreate_Polygon_triggered(bool checked)
 {
     if(checked) {
@@ -311,13 +859,71 @@ void MainWindow::on_actionCreate_Rectangle_triggered(bool checked)
     }
 }
 
+void MainWindow::on_actionFreehand_Polygon_triggered(bool checked)
+{
+    if(checked) {
+        if(ui->labelListWidget->currentItem()){
+            scene->setCurrentLabel(ui->labelListWidget->currentItem()->text());
+            scene->setMode(CanvasScene::FreehandPolygon);
+            statusBar()->showMessage("模式：自由绘制多边形。按住鼠标沿边界拖动，松开完成。", 0);
+        } else {
+            statusBar()->showMessage("请先在右侧选择一个标签！", 3000);
+            ui->actionFreehand_Polygon->setChecked(false);
+        }
+    } else {
+        scene->setMode(CanvasScene::NoMode);
+        statusBar()->clearMessage();
+    }
+}
+
+void MainWindow::on_actionMagic_Wand_triggered(bool checked)
+{
+    if(checked) {
+        if(ui->labelListWidget->currentItem()){
+            scene->setCurrentLabel(ui->labelListWidget->currentItem()->text());
+            scene->setMode(CanvasScene::MagicWand);
+            statusBar()->showMessage(QString("模式：魔棒（容差 %1）。单击选择区域，[ ] 调整容差，回车确认。")
+                                         .arg(scene->magicWandTolerance()), 0);
+        } else {
+            statusBar()->showMessage("请先在右侧选择一个标签！", 3000);
+            ui->actionMagic_Wand->setChecked(false);
+        }
+    } else {
+        scene->setMode(CanvasScene::NoMode);
+        statusBar()->clearMessage();
+    }
+}
+
+void MainWindow::on_actionEdit_Boundary_triggered(bool checked)
+{
+    if(checked) {
+        scene->setMode(CanvasScene::EditPolygonBoundary);
+        statusBar()->showMessage("模式：修整边界。从多边形边界附近开始描一段新的边界，松开后替换原来的一段。", 0);
+    } else {
+        scene->setMode(CanvasScene::NoMode);
+        statusBar()->clearMessage();
+    }
+}
+
+void MainWindow::on_actionCached_Rendering_triggered(bool checked)
+{
+    scene->setCachedRendering(checked);
+}
+
+void MainWindow::on_actionAdaptive_Quality_triggered(bool checked)
+{
+    view->setAdaptiveQuality(checked);
+}
+
 void MainWindow::handlePolygonFinished(PolygonItem* item)
 {
+    annotationsDirty = true;
     updateShapeList();
 }
 
 void MainWindow::handleRectangleFinished(RectangleItem* item)
 {
+    annotationsDirty = true;
     updateShapeList();
 }
 
@@ -337,6 +943,7 @@ void MainWindow::deleteSelectedShape()
         scene->removeItem(item);
         delete item;
     }
+    annotationsDirty = true;
     updateShapeList();
 }
 
@@ -366,6 +973,7 @@ void MainWindow::changeSelectedShapeLabel()
             rectangleItem->setLabel(newLabel);
         }
         item->update();
+        annotationsDirty = true;
         updateShapeList();
     }
 }
@@ -382,6 +990,7 @@ void MainWindow::on_shapeListWidget_customContextMenuRequested(const QPoint &pos
             QGraphicsItem* graphicsItem = item->data(Qt::UserRole).value<QGraphicsItem*>();
             scene->removeItem(graphicsItem);
             delete graphicsItem;
+            annotationsDirty = true;
             updateShapeList();
         } else if (selectedAction == editAction) {
             QGraphicsItem* graphicsItem = item->data(Qt::UserRole).value<QGraphicsItem*>();
@@ -397,9 +1006,10 @@ void MainWindow::updateShapeList()
 {
     ui->shapeListWidget->clear();
     for (QGraphicsItem *item : scene->items()) {
+        const QString suffix = CanvasScene::isSuggestion(item) ? " - 建议" : "";
         if (auto polygonItem = dynamic_cast<PolygonItem*>(item)) {
              QListWidgetItem* listItem = new QListWidgetItem(
-                QString("%1 (Polygon)").arg(polygonItem->getLabel()),
+                QString("%1 (Polygon)%2").arg(polygonItem->getLabel(), suffix),
                 ui->shapeListWidget
             );
             listItem->setData(Qt::UserRole, QVariant::fromValue<QGraphicsItem*>(polygonItem));
@@ -409,7 +1019,7 @@ void MainWindow::updateShapeList()
             }
         } else if (auto rectangleItem = dynamic_cast<RectangleItem*>(item)) {
             QListWidgetItem* listItem = new QListWidgetItem(
-                QString("%1 (Rectangle)").arg(rectangleItem->getLabel()),
+                QString("%1 (Rectangle)%2").arg(rectangleItem->getLabel(), suffix),
                 ui->shapeListWidget
             );
             listItem->setData(Qt::UserRole, QVariant::fromValue<QGraphicsItem*>(rectangleItem));
@@ -420,3 +1030,314 @@ void MainWindow::updateShapeList()
         }
     }
 }
+
+
+QList<QGraphicsItem*> MainWindow::annotationItems() const
+{
+    // 同一层级的item按插入顺序排列，因此结果与sidecar文件中的形状顺序一致。
+    // 建议不在文件中，不参与编号。
+    QList<QGraphicsItem*> result;
+    for (QGraphicsItem *item : scene->items(Qt::AscendingOrder)) {
+        if ((dynamic_cast<PolygonItem*>(item) || dynamic_cast<RectangleItem*>(item))
+            && !CanvasScene::isSuggestion(item)) {
+            result.append(item);
+        }
+    }
+    return result;
+}
+
+QList<AnnotationShape> MainWindow::annotationShapes(const QList<QGraphicsItem*> &items) const
+{
+    // 使用场景坐标，包含item被整体拖动后的位移
+    QList<AnnotationShape> shapes;
+    for (QGraphicsItem *item : items) {
+        AnnotationShape shape;
+        if (auto polygonItem = dynamic_cast<PolygonItem*>(item)) {
+            shape.label = polygonItem->getLabel();
+            shape.shapeType = "polygon";
+            shape.points = polygonItem->mapToScene(polygonItem->polygon());
+        } else if (auto rectangleItem = dynamic_cast<RectangleItem*>(item)) {
+            const QRectF rect = rectangleItem->rect();
+            shape.label = rectangleItem->getLabel();
+            shape.shapeType = "rectangle";
+            shape.points << rectangleItem->mapToScene(rect.topLeft()) << rectangleItem->mapToScene(rect.bottomRight());
+        } else {
+            continue;
+        }
+        shapes.append(shape);
+    }
+    return shapes;
+}
+
+QList<ValidationTask> MainWindow::datasetTasks() const
+{
+    QList<ValidationTask> tasks;
+    tasks.reserve(imageFiles.size());
+    for (const QString &fileName : imageFiles) {
+        ValidationTask task;
+        task.fileName = fileName;
+        task.source = imageSource.get();
+        task.jsonPath = imageSource->annotationPath(fileName);
+        tasks.append(task);
+    }
+    return tasks;
+}
+
+void MainWindow::trackDatasetProgress(QFutureWatcherBase *watcher, const QString &text, int count)
+{
+    auto progress = new QProgressDialog(text, "取消", 0, count, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(watcher, &QFutureWatcherBase::finished, progress, &QProgressDialog::close);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcherBase::cancel);
+}
+
+void MainWindow::on_actionValidate_Dataset_triggered()
+{
+    if (imageFiles.isEmpty()) {
+        statusBar()->showMessage("请先打开一个文件夹。", 3000);
+        return;
+    }
+    if (validationWatcher->isRunning()) {
+        return;
+    }
+
+    QList<ValidationTask> tasks = datasetTasks();
+    QStringList knownLabels;
+    for (int i = 0; i < ui->labelListWidget->count(); ++i) {
+        knownLabels << ui->labelListWidget->item(i)->text();
+    }
+
+    trackDatasetProgress(validationWatcher, "正在检查数据集...", tasks.size());
+
+    // map: 每个工作线程独立解析并检查一个sidecar；reduce: 在结果到达时合并统计
+    validationWatcher->setFuture(QtConcurrent::mappedReduced<DatasetStatistics>(
+        tasks,
+        [knownLabels](const ValidationTask &task) {
+            return DatasetValidator::validateFile(task, knownLabels);
+        },
+        &DatasetValidator::merge,
+        QtConcurrent::UnorderedReduce));
+}
+
+void MainWindow::handleValidationFinished()
+{
+    if (validationWatcher->isCanceled()) {
+        statusBar()->showMessage("数据集检查已取消。", 3000);
+        return;
+    }
+
+    DatasetStatistics statistics = validationWatcher->result();
+    // UnorderedReduce 不保证顺序，按文件名排序后再显示
+    std::stable_sort(statistics.issues.begin(), statistics.issues.end(),
+                     [](const DatasetIssue &a, const DatasetIssue &b) { return a.fileName < b.fileName; });
+    showDatasetReport(DatasetValidator::formatSummary(statistics), statistics.issues);
+}
+
+void MainWindow::on_actionFind_Overlaps_triggered()
+{
+    if (imageFiles.isEmpty()) {
+        statusBar()->showMessage("请先打开一个文件夹。", 3000);
+        return;
+    }
+    if (overlapWatcher->isRunning()) {
+        return;
+    }
+
+    bool ok;
+    double threshold = QInputDialog::getDouble(this, "检查重叠标注", "IoU 阈值:", 0.5, 0.01, 1.0, 2, &ok);
+    if (!ok) {
+        return;
+    }
+
+    QList<ValidationTask> tasks = datasetTasks();
+    trackDatasetProgress(overlapWatcher, "正在检查重叠标注...", tasks.size());
+
+    overlapWatcher->setFuture(QtConcurrent::mappedReduced<QList<DatasetIssue>>(
+        tasks,
+        [threshold](const ValidationTask &task) {
+            return OverlapDetector::checkFile(task, threshold);
+        },
+        [](QList<DatasetIssue> &result, const QList<DatasetIssue> &partial) {
+            result.append(partial);
+        },
+        QtConcurrent::OrderedReduce));
+}
+
+void MainWindow::handleOverlapSearchFinished()
+{
+    if (overlapWatcher->isCanceled()) {
+        statusBar()->showMessage("重叠检查已取消。", 3000);
+        return;
+    }
+
+    QList<DatasetIssue> issues = overlapWatcher->result();
+    QString summary = QString("在 %1 张图片中发现 %2 对重叠标注。").arg(imageFiles.size()).arg(issues.size());
+    showDatasetReport(summary, issues);
+}
+
+void MainWindow::on_actionFind_Duplicates_triggered()
+{
+    if (imageFiles.isEmpty()) {
+        statusBar()->showMessage("请先打开一个文件夹。", 3000);
+        return;
+    }
+    if (hashWatcher->isRunning()) {
+        return;
+    }
+
+    bool ok;
+    int threshold = QInputDialog::getInt(this, "查找重复图片", "最大汉明距离 (0-16):", duplicateThreshold, 0, 16, 1, &ok);
+    if (!ok) {
+        return;
+    }
+    duplicateThreshold = threshold;
+
+    // 缓存中的记录随任务一起交给工作线程，由工作线程比较修改时间
+    const QHash<QString, HashRecord> cached = DuplicateFinder::readCache(imageSource->cachePath("hashes.json"));
+    QList<HashTask> tasks;
+    tasks.reserve(imageFiles.size());
+    for (const QString &entry : imageFiles) {
+        HashTask task;
+        task.entry = entry;
+        task.source = imageSource.get();
+        task.cached = cached.value(entry);
+        tasks.append(task);
+    }
+
+    trackDatasetProgress(hashWatcher, "正在计算图片哈希...", tasks.size());
+    hashWatcher->setFuture(QtConcurrent::mapped(tasks, &DuplicateFinder::hashEntry));
+}
+
+void MainWindow::handleHashingFinished()
+{
+    if (hashWatcher->isCanceled()) {
+        statusBar()->showMessage("重复图片检查已取消。", 3000);
+        return;
+    }
+
+    const QList<HashRecord> records = hashWatcher->future().results();
+    DuplicateFinder::writeCache(imageSource->cachePath("hashes.json"), records);
+
+    duplicateGroups = DuplicateFinder::findGroups(records, duplicateThreshold);
+    duplicateGroupOf.clear();
+    int duplicateCount = 0;
+    for (int group = 0; group < duplicateGroups.size(); ++group) {
+        for (const QString &entry : duplicateGroups[group]) {
+            duplicateGroupOf.insert(entry, group);
+        }
+        duplicateCount += duplicateGroups[group].size() - 1;
+    }
+    applyDuplicateMarks();
+    statusBar()->showMessage(QString("发现 %1 组近似重复图片，其中 %2 张可以跳过。")
+                                 .arg(duplicateGroups.size()).arg(duplicateCount), 5000);
+}
+
+void MainWindow::applyDuplicateMarks()
+{
+    const bool hide = ui->actionHide_Duplicates->isChecked();
+    const QBrush duplicateBrush = palette().brush(QPalette::Disabled, QPalette::Text);
+    for (int row = 0; row < ui->fileListWidget->count() && row < imageFiles.size(); ++row) {
+        QListWidgetItem *item = ui->fileListWidget->item(row);
+        const QString &entry = imageFiles[row];
+        const int group = duplicateGroupOf.value(entry, -1);
+        if (group < 0) {
+            item->setForeground(QBrush());
+            item->setToolTip(QString());
+            item->setHidden(false);
+            continue;
+        }
+
+        const QStringList &members = duplicateGroups[group];
+        const bool duplicate = members.first() != entry;
+        item->setForeground(duplicate ? duplicateBrush : QBrush());
+        item->setToolTip(duplicate ? "与 " + members.first() + " 近似重复"
+                                   : QString("重复组共 %1 张").arg(members.size()));
+        item->setHidden(hide && duplicate);
+    }
+}
+
+void MainWindow::on_actionHide_Duplicates_triggered(bool checked)
+{
+    Q_UNUSED(checked);
+    applyDuplicateMarks();
+}
+
+void MainWindow::on_actionCopy_To_Duplicates_triggered()
+{
+    if (currentFileIndex == -1) {
+        return;
+    }
+    const QString entry = imageFiles[currentFileIndex];
+    const int group = duplicateGroupOf.value(entry, -1);
+    if (group < 0) {
+        statusBar()->showMessage("当前图片没有近似重复的图片，请先运行 \"查找重复图片\"。", 3000);
+        return;
+    }
+
+    QStringList targets = duplicateGroups[group];
+    targets.removeAll(entry);
+    int existing = 0;
+    for (const QString &target : targets) {
+        if (QFileInfo::exists(imageSource->annotationPath(target))) {
+            ++existing;
+        }
+    }
+    if (existing > 0
+        && QMessageBox::question(this, "复制标注", QString("重复组中有 %1 张图片已有标注文件，要覆盖它们吗？").arg(existing))
+               != QMessageBox::Yes) {
+        return;
+    }
+
+    // 近似重复的图片几何上一致，把当前场景中的标注原样写到组内其他图片的 sidecar
+    for (const QString &target : targets) {
+        saveAnnotations(target);
+    }
+    statusBar()->showMessage(QString("已把 %1 个标注复制到 %2 张重复图片。")
+                                 .arg(annotationItems().size()).arg(targets.size()), 5000);
+}
+
+void MainWindow::showDatasetReport(const QString &summary, const QList<DatasetIssue> &issues)
+{
+    if (!reportDialog) {
+        reportDialog = new DatasetReportDialog(this);
+        connect(reportDialog, &DatasetReportDialog::issueActivated, this, &MainWindow::showDatasetIssue);
+    }
+    reportDialog->setReport(summary, issues);
+    reportDialog->show();
+    reportDialog->raise();
+    reportDialog->activateWindow();
+}
+
+void MainWindow::showDatasetIssue(const DatasetIssue &issue)
+{
+    int index = imageFiles.indexOf(issue.fileName);
+    if (index < 0) {
+        statusBar()->showMessage("错误：文件已不在列表中 " + issue.fileName, 3000);
+        return;
+    }
+    if (index != currentFileIndex) {
+        currentFileIndex = index;
+        ui->fileListWidget->setCurrentRow(currentFileIndex);
+        loadImage(imageFiles[currentFileIndex]);
+    }
+
+    QList<QGraphicsItem*> items = annotationItems();
+    scene->clearSelection();
+    QRectF focusRect;
+    QList<QPainterPath> highlights;
+    for (int shapeIndex : issue.shapeIndices) {
+        if (shapeIndex >= 0 && shapeIndex < items.size()) {
+            QGraphicsItem *item = items[shapeIndex];
+            item->setSelected(true);
+            focusRect |= item->sceneBoundingRect();
+            highlights << item->sceneTransform().map(item->shape());
+        }
+    }
+    scene->setHighlights(highlights);
+    if (!focusRect.isNull()) {
+        view->centerOn(focusRect.center());
+    }
+    statusBar()->showMessage(issue.fileName + ": " + issue.message, 5000);
+}
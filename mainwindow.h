@@ -7,6 +7,14 @@
 
 #include <QMainWindow>
 #include <QListWidgetItem>
+#include <QFutureWatcher>
+#include <QDateTime>
+#include "datasetvalidator.h"
+#include "annotationfile.h"
+#include "imagesource.h"
+#include "templatetracker.h"
+#include "duplicatefinder.h"
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -16,6 +24,11 @@ class CanvasScene;
 class PolygonItem;
 class RectangleItem;
 class CanvasView;
+class DatasetReportDialog;
+class PreAnnotationScheduler;
+class QGraphicsItem;
+class QFileSystemWatcher;
+class QTimer;
 
 class MainWindow : public QMainWindow
 {
@@ -32,6 +45,7 @@ public slots:
 private slots:
     // 文件操作
     void on_actionOpen_Folder_triggered();
+    void on_actionOpen_Archive_triggered();
     void on_actionSave_triggered();
 
     // 列表点击事件
@@ -40,8 +54,17 @@ private slots:
     // 工具栏动作
     void on_actionNext_Image_triggered();
     void on_actionPrev_Image_triggered();
+    void on_actionCarry_Forward_triggered();
+    void handleTrackingFinished();
+    void on_actionAccept_Suggestions_triggered();
+    void on_actionReject_Suggestions_triggered();
     void on_actionCreate_Polygon_triggered(bool checked);
     void on_actionCreate_Rectangle_triggered(bool checked);
+    void on_actionFreehand_Polygon_triggered(bool checked);
+    void on_actionEdit_Boundary_triggered(bool checked);
+    void on_actionMagic_Wand_triggered(bool checked);
+    void on_actionCached_Rendering_triggered(bool checked);
+    void on_actionAdaptive_Quality_triggered(bool checked);
     
     // 自定义槽函数
     void handlePolygonFinished(PolygonItem* item);
@@ -53,21 +76,98 @@ private slots:
     void on_deleteLabelButton_clicked();
     void on_shapeListWidget_customContextMenuRequested(const QPoint &pos);
 
+    // 数据集检查
+    void on_actionValidate_Dataset_triggered();
+    void handleValidationFinished();
+    void on_actionFind_Overlaps_triggered();
+    void handleOverlapSearchFinished();
+    void showDatasetIssue(const DatasetIssue& issue);
+    void on_actionFind_Duplicates_triggered();
+    void handleHashingFinished();
+    void on_actionHide_Duplicates_triggered(bool checked);
+    void on_actionCopy_To_Duplicates_triggered();
+
+    // 监视的文件或目录发生变化，跳过自己刚写入的 sidecar 后交给去抖定时器
+    void handleWatchedPathChanged(const QString& path);
+    // 数据集目录变化（已去抖）
+    void handleDatasetChanged();
+
+    // 预标注插件
+    void on_actionLoad_Plugin_triggered();
+    void handlePreAnnotationReady(const QString& entry);
+
+    // 高位深图片的窗宽窗位
+    void on_windowCenterSlider_valueChanged(int value);
+    void on_windowWidthSlider_valueChanged(int value);
+    void on_gammaSpinBox_valueChanged(double value);
+    void on_autoWindowButton_clicked();
+
 
 private:
     void loadDirectory(const QString& path);
-    void loadImage(const QString& imagePath);
-    void saveAnnotations(const QString& imagePath);
-    void loadAnnotations(const QString& imagePath);
+    void loadImage(const QString& entry);
+    void saveAnnotations(const QString& entry);
+    void loadAnnotations(const AnnotationFile& annotation);
+    QList<QGraphicsItem*> createAnnotationItems(const QList<AnnotationShape>& shapes) const;
     void populateLabels();
+    void updateDisplayControls();
+    void applyDisplayControls();
     void updateShapeList();
+    void stopDatasetJobs();
+    QList<QGraphicsItem*> annotationItems() const;
+    QList<AnnotationShape> annotationShapes(const QList<QGraphicsItem*>& items) const;
+    QList<QGraphicsItem*> targetSuggestions() const;
+    QList<ValidationTask> datasetTasks() const;
+    void trackDatasetProgress(QFutureWatcherBase* watcher, const QString& text, int count);
+    void showDatasetReport(const QString& summary, const QList<DatasetIssue>& issues);
+    void applyDuplicateMarks();
+    void goToImage(int step);
+    void refreshEntries(const QStringList& fresh);
+    void checkCurrentEntryChanged();
+    void reloadAnnotations(const QString& entry);
+    void watchCurrentFiles(const QString& entry);
 
     Ui::MainWindow *ui;
     CanvasView* view;
     CanvasScene* scene;
     
-    QString currentDirectory;
+    std::unique_ptr<ImageSource> imageSource;
+    QString currentDirectory; // 打开的文件夹或归档路径
     QStringList imageFiles;
     int currentFileIndex = -1;
+
+    QFutureWatcher<DatasetStatistics>* validationWatcher;
+    QFutureWatcher<QList<DatasetIssue>>* overlapWatcher;
+    DatasetReportDialog* reportDialog = nullptr;
+
+    // 近似重复图片：每组第一张为代表，其余的可以在文件列表中隐藏
+    QFutureWatcher<HashRecord>* hashWatcher;
+    int duplicateThreshold = 6;
+    QList<QStringList> duplicateGroups;
+    QHash<QString, int> duplicateGroupOf;
+
+    // 监视数据集目录和当前图片的 sidecar。变化先经过定时器合并，再与当前状态比较。
+    QFileSystemWatcher* datasetWatcher;
+    QTimer* datasetChangeTimer;
+    QStringList watchedCurrentPaths;
+    QString currentImageStamp;
+    QString currentSidecarStamp;
+    // 在工作线程中列出文件夹；切换数据集时递增代数，丢弃旧数据集的列表
+    QFuture<QStringList> entriesFuture;
+    int datasetGeneration = 0;
+    // 最近一次自己写入的 sidecar 及写入后的状态，对应的监视事件不当作外部修改
+    QString ownSidecarPath;
+    QString ownSidecarStamp;
+    QDateTime ownSidecarDirModified;
+    bool annotationsDirty = false; // 当前图片有未保存的修改
+    bool annotationConflict = false; // 有未保存的修改时 sidecar 被外部改写，保存前需要确认
+
+    // 带入下一张：切换图片时递增，丢弃仍在进行的旧跟踪
+    QFutureWatcher<TrackedShape>* trackingWatcher;
+    int trackingGeneration = 0;
+    int trackingJobGeneration = -1; // trackingWatcher 中的任务开始时的代数
+
+    PreAnnotationScheduler* preAnnotation;
+    bool preAnnotationPending = false; // 当前图片在等待预标注结果
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,76 @@
+/* *************************************************************** */
+/* overlapdetector.cpp                     */
+/* *************************************************************** */
+#include "overlapdetector.h"
+#include "rtree.h"
+#include "shapegeometry.h"
+
+#include <QFileInfo>
+
+QList<DatasetIssue> OverlapDetector::findOverlaps(const QList<AnnotationShape> &shapes, qreal iouThreshold,
+                                                  const QString &fileName)
+{
+    // 只保留会被加载到场景中的形状，序号与 MainWindow::annotationItems() 对应
+    QVector<QPolygonF> polygons;
+    QVector<QRectF> boxes;
+    QStringList labels;
+    for (const AnnotationShape &shape : shapes) {
+        QPolygonF polygon;
+        if (shape.shapeType == "polygon") {
+            polygon = shape.points;
+        } else if (shape.shapeType == "rectangle") {
+            if (shape.points.size() == 2) {
+                polygon = ShapeGeometry::rectangleToPolygon(QRectF(shape.points[0], shape.points[1]));
+            }
+        } else {
+            continue;
+        }
+        polygons.append(polygon);
+        boxes.append(polygon.boundingRect());
+        labels.append(shape.label);
+    }
+
+    QList<DatasetIssue> issues;
+    BoxRTree tree(boxes);
+    for (int i = 0; i < polygons.size(); ++i) {
+        if (polygons[i].size() < 3) {
+            continue;
+        }
+        const QVector<int> candidates = tree.query(boxes[i]);
+        for (int j : candidates) {
+            // 每一对只计算一次
+            if (j <= i || polygons[j].size() < 3) {
+                continue;
+            }
+            qreal iou = ShapeGeometry::intersectionOverUnion(polygons[i], polygons[j]);
+            if (iou < iouThreshold) {
+                continue;
+            }
+
+            DatasetIssue issue;
+            issue.fileName = fileName;
+            issue.shapeIndices << i << j;
+            if (labels[i] == labels[j]) {
+                issue.label = labels[i];
+                issue.message = QString("疑似重复标注 (IoU %1)").arg(iou, 0, 'f', 2);
+            } else {
+                issue.label = labels[i] + " / " + labels[j];
+                issue.message = QString("重叠标注的标签冲突 (IoU %1)").arg(iou, 0, 'f', 2);
+            }
+            issues.append(issue);
+        }
+    }
+    return issues;
+}
+
+QList<DatasetIssue> OverlapDetector::checkFile(const ValidationTask &task, qreal iouThreshold)
+{
+    if (!QFileInfo::exists(task.jsonPath)) {
+        return {};
+    }
+    AnnotationFile annotation;
+    if (!readAnnotationFile(task.jsonPath, &annotation)) {
+        return {};
+    }
+    return findOverlaps(annotation.shapes, iouThreshold, task.fileName);
+}
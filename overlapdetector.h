@@ -0,0 +1,22 @@
+/* *************************************************************** */
+/* overlapdetector.h                       */
+/* *************************************************************** */
+#ifndef OVERLAPDETECTOR_H
+#define OVERLAPDETECTOR_H
+
+#include "annotationfile.h"
+#include "datasetvalidator.h"
+
+// 重复/重叠标注检测：用R树筛选包围盒相交的候选对，只对候选对计算精确的IoU
+class OverlapDetector
+{
+public:
+    // 检查一组形状（顺序与加载后的形状一致），返回 IoU 不低于阈值的形状对
+    static QList<DatasetIssue> findOverlaps(const QList<AnnotationShape>& shapes, qreal iouThreshold,
+                                            const QString& fileName);
+
+    // 读取一个 sidecar 文件并检查其中的形状，线程安全
+    static QList<DatasetIssue> checkFile(const ValidationTask& task, qreal iouThreshold);
+};
+
+#endif // OVERLAPDETECTOR_H
@@ -0,0 +1,77 @@
+/* *************************************************************** */
+/* referenceplugin.cpp                       */
+/* *************************************************************** */
+#include "referenceplugin.h"
+
+#include <QtMath>
+
+namespace {
+
+const int AnalysisSize = 256; // 在缩小后的灰度图上判断，原图再大也只处理这么多像素
+
+QList<AnnotationShape> brightRegion(const QImage &image)
+{
+    if (image.isNull()) {
+        return {};
+    }
+    const QImage gray = image.scaled(AnalysisSize, AnalysisSize, Qt::KeepAspectRatio, Qt::FastTransformation)
+                            .convertToFormat(QImage::Format_Grayscale8);
+
+    double sum = 0;
+    double sumSquares = 0;
+    for (int y = 0; y < gray.height(); ++y) {
+        const uchar *row = gray.constScanLine(y);
+        for (int x = 0; x < gray.width(); ++x) {
+            sum += row[x];
+            sumSquares += double(row[x]) * row[x];
+        }
+    }
+    const double count = double(gray.width()) * gray.height();
+    const double mean = sum / count;
+    const double deviation = qSqrt(qMax(0.0, sumSquares / count - mean * mean));
+    const double threshold = mean + deviation;
+
+    int left = gray.width();
+    int top = gray.height();
+    int right = -1;
+    int bottom = -1;
+    for (int y = 0; y < gray.height(); ++y) {
+        const uchar *row = gray.constScanLine(y);
+        for (int x = 0; x < gray.width(); ++x) {
+            if (row[x] > threshold) {
+                left = qMin(left, x);
+                right = qMax(right, x);
+                top = qMin(top, y);
+                bottom = qMax(bottom, y);
+            }
+        }
+    }
+    if (right < 0) {
+        return {};
+    }
+
+    const qreal scaleX = qreal(image.width()) / gray.width();
+    const qreal scaleY = qreal(image.height()) / gray.height();
+    AnnotationShape shape;
+    shape.label = "object";
+    shape.shapeType = "rectangle";
+    shape.points << QPointF(left * scaleX, top * scaleY) << QPointF((right + 1) * scaleX, (bottom + 1) * scaleY);
+    return {shape};
+}
+
+} // namespace
+
+QString ReferencePlugin::name() const
+{
+    return "Reference (bright region)";
+}
+
+QList<QList<AnnotationShape>> ReferencePlugin::annotate(const QList<QImage> &images)
+{
+    QList<QList<AnnotationShape>> results;
+    results.reserve(images.size());
+    for (const QImage &image : images) {
+        results.append(brightRegion(image));
+    }
+    return results;
+}
@@ -0,0 +1,23 @@
+/* *************************************************************** */
+/* referenceplugin.h                       */
+/* *************************************************************** */
+#ifndef REFERENCEPLUGIN_H
+#define REFERENCEPLUGIN_H
+
+#include <QObject>
+#include "labelerplugin.h"
+
+// 参考插件：不依赖任何模型，把每张图片中明显偏亮的区域框成一个矩形。
+// 用于在没有真实检测器时测试预标注流程。
+class ReferencePlugin : public QObject, public LabelerPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID LabelerPlugin_iid FILE "referenceplugin.json")
+    Q_INTERFACES(LabelerPlugin)
+
+public:
+    QString name() const override;
+    QList<QList<AnnotationShape>> annotate(const QList<QImage>& images) override;
+};
+
+#endif // REFERENCEPLUGIN_H
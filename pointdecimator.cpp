@@ -0,0 +1,123 @@
+/* *************************************************************** */
+/* pointdecimator.cpp                      */
+/* *************************************************************** */
+#include "pointdecimator.h"
+
+#include <QLineF>
+#include <QVector>
+#include <QPair>
+
+namespace {
+
+qreal distanceToSegment(const QPointF &p, const QPointF &a, const QPointF &b)
+{
+    const QPointF ab = b - a;
+    const qreal lengthSquared = QPointF::dotProduct(ab, ab);
+    if (lengthSquared <= 0.0) {
+        return QLineF(p, a).length();
+    }
+    qreal t = QPointF::dotProduct(p - a, ab) / lengthSquared;
+    t = qBound<qreal>(0.0, t, 1.0);
+    return QLineF(p, a + ab * t).length();
+}
+
+} // namespace
+
+StreamingDecimator::StreamingDecimator(qreal minDistance, qreal tolerance, int maxWindow)
+    : minDistance(minDistance)
+    , tolerance(tolerance)
+    , maxWindow(qMax(2, maxWindow))
+{
+}
+
+void StreamingDecimator::setThresholds(qreal newMinDistance, qreal newTolerance)
+{
+    minDistance = newMinDistance;
+    tolerance = newTolerance;
+}
+
+void StreamingDecimator::reset()
+{
+    committed.clear();
+    window.clear();
+}
+
+bool StreamingDecimator::addPoint(const QPointF &point)
+{
+    if (committed.isEmpty()) {
+        committed << point;
+        return true;
+    }
+
+    // 径向距离过滤：离上一个输入点太近的点直接丢弃
+    const QPointF &previous = window.isEmpty() ? committed.last() : window.last();
+    if (QLineF(previous, point).length() < minDistance) {
+        return false;
+    }
+
+    const QPointF &anchor = committed.last();
+    bool fits = window.size() < maxWindow;
+    for (int i = 0; fits && i < window.size(); ++i) {
+        fits = distanceToSegment(window[i], anchor, point) <= tolerance;
+    }
+
+    if (fits) {
+        window << point;
+        return false;
+    }
+
+    // 新点让直线近似失效：前一个候选点成为新的确定点
+    committed << window.last();
+    window.clear();
+    window << point;
+    return true;
+}
+
+void StreamingDecimator::finish()
+{
+    if (!window.isEmpty()) {
+        committed << window.last();
+        window.clear();
+    }
+}
+
+QPolygonF StreamingDecimator::simplify(const QPolygonF &points, qreal tolerance)
+{
+    const int n = points.size();
+    if (n < 3) {
+        return points;
+    }
+
+    QVector<bool> keep(n, false);
+    keep[0] = true;
+    keep[n - 1] = true;
+
+    // 用显式栈代替递归，长轮廓不会栈溢出
+    QVector<QPair<int, int>> stack;
+    stack.append({0, n - 1});
+    while (!stack.isEmpty()) {
+        const QPair<int, int> range = stack.takeLast();
+        qreal maxDistance = 0.0;
+        int index = -1;
+        for (int i = range.first + 1; i < range.second; ++i) {
+            qreal distance = distanceToSegment(points[i], points[range.first], points[range.second]);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                index = i;
+            }
+        }
+        if (index >= 0 && maxDistance > tolerance) {
+            keep[index] = true;
+            stack.append({range.first, index});
+            stack.append({index, range.second});
+        }
+    }
+
+    QPolygonF result;
+    for (int i = 0; i < n; ++i) {
+        if (keep[i]) {
+            result << points[i];
+        }
+    }
+    return result;
+}
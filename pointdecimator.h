@@ -0,0 +1,40 @@
+/* *************************************************************** */
+/* pointdecimator.h                        */
+/* *************************************************************** */
+#ifndef POINTDECIMATOR_H
+#define POINTDECIMATOR_H
+
+#include <QPolygonF>
+
+// 流式折线抽稀，用于自由绘制时的高频鼠标/数位板输入。
+// 先按最小间距丢弃过密的点，再对上一个确定点之后的候选点做窗口化的 Douglas–Peucker 判断：
+// 候选点到“确定点→新点”线段的距离都在容差内时继续累积，否则确定前一个候选点。
+class StreamingDecimator
+{
+public:
+    explicit StreamingDecimator(qreal minDistance = 2.0, qreal tolerance = 1.5, int maxWindow = 64);
+
+    void reset();
+    // 两个阈值与输入点使用同一单位；输入是场景坐标时按视图缩放换算
+    void setThresholds(qreal newMinDistance, qreal newTolerance);
+    // 加入一个原始输入点，返回 true 表示确定了新的点
+    bool addPoint(const QPointF& point);
+    // 输入结束，最后一个候选点也作为确定点
+    void finish();
+
+    const QPolygonF& committedPoints() const { return committed; }
+    // 上一个确定点之后尚未确定的点，用于预览尾部
+    const QPolygonF& pendingPoints() const { return window; }
+
+    // 经典 Douglas–Peucker 简化（非流式）
+    static QPolygonF simplify(const QPolygonF& points, qreal tolerance);
+
+private:
+    qreal minDistance;
+    qreal tolerance;
+    int maxWindow;
+    QPolygonF committed;
+    QPolygonF window;
+};
+
+#endif // POINTDECIMATOR_H
@@ -3,6 +3,7 @@
 /* polygonitem.cpp                         */
 /* *************************************************************** */
 #include "polygonitem.h"
+#include "canvasscene.h"
 
 PolygonItem::PolygonItem(const QPolygonF &polygon, QGraphicsItem *parent)
     : QGraphicsPolygonItem(polygon, parent)
@@ -15,6 +16,9 @@ PolygonItem::PolygonItem(const QPolygonF &polygon, QGraphicsItem *parent)
 void PolygonItem::setLabel(const QString &label)
 {
     itemLabel = label;
+    if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+        canvas->annotationChanged(this);
+    }
 }
 
 QString PolygonItem::getLabel() const
@@ -24,6 +28,12 @@ QString PolygonItem::getLabel() const
 
 void PolygonItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
+    // 未选中的标注已经画在场景的缓存图层里
+    auto canvas = qobject_cast<CanvasScene*>(scene());
+    if (canvas && canvas->isDrawnFromCache(this)) {
+        return;
+    }
+
     // 调用基类的paint来绘制多边形本身
     QGraphicsPolygonItem::paint(painter, option, widget);
     
@@ -61,6 +71,22 @@ void PolygonItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
     QGraphicsItem::hoverMoveEvent(event);
 }
 
+void PolygonItem::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
+{
+    if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+        canvas->setHoveredAnnotation(this);
+    }
+    QGraphicsPolygonItem::hoverEnterEvent(event);
+}
+
+void PolygonItem::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
+{
+    if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+        canvas->setHoveredAnnotation(nullptr);
+    }
+    QGraphicsPolygonItem::hoverLeaveEvent(event);
+}
+
 void PolygonItem::mousePressEvent(QGraphicsSceneMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton && isSelected()) {
@@ -92,6 +118,26 @@ void PolygonItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 
 void PolygonItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
+    if (draggingVertexIndex != -1) {
+        if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+            canvas->notifyAnnotationEdited();
+        }
+    }
     draggingVertexIndex = -1; // 释放鼠标，重置拖拽状态
     QGraphicsItem::mouseReleaseEvent(event);
 }
+
+QVariant PolygonItem::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+        if (change == ItemSceneChange) {
+            canvas->annotationRemoved(this);
+        } else if (change == ItemSceneHasChanged || change == ItemSelectedHasChanged
+                   || change == ItemFlagsHaveChanged || change == ItemVisibleHasChanged) {
+            canvas->annotationChanged(this);
+        } else if (change == ItemPositionHasChanged) {
+            canvas->annotationChanged(this, true);
+        }
+    }
+    return QGraphicsPolygonItem::itemChange(change, value);
+}
@@ -22,10 +22,15 @@ protected:
     
     // 添加鼠标事件来处理顶点拖拽
     void hoverMoveEvent(QGraphicsSceneHoverEvent *event) override;
+    void hoverEnterEvent(QGraphicsSceneHoverEvent *event) override;
+    void hoverLeaveEvent(QGraphicsSceneHoverEvent *event) override;
     void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
     void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
 
+    // 通知 CanvasScene 更新缓存图层
+    QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
+
 private:
     QString itemLabel;
     
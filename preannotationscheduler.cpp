@@ -0,0 +1,198 @@
+/* *************************************************************** */
+/* preannotationscheduler.cpp                    */
+/* *************************************************************** */
+#include "preannotationscheduler.h"
+#include "labelerplugin.h"
+#include "imagesource.h"
+
+#include <QPluginLoader>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace {
+
+// 推理通常本身就是多线程的，同时运行的批次不宜太多
+const int MaxWorkers = 2;
+// 缓存的结果数至少能容纳几个预取窗口，来回翻看附近的图片时不必重新推理
+const int MinCachedResults = 64;
+const int CachedWindows = 4;
+
+} // namespace
+
+struct PreAnnotationScheduler::SharedState
+{
+    QMutex mutex;
+    QSet<QString> window; // 当前预取窗口内的条目
+};
+
+PreAnnotationScheduler::PreAnnotationScheduler(QObject *parent)
+    : QObject(parent)
+    , shared(std::make_shared<SharedState>())
+{
+    pool.setMaxThreadCount(MaxWorkers);
+    setLookahead(lookahead);
+}
+
+PreAnnotationScheduler::~PreAnnotationScheduler()
+{
+    // 工作线程持有插件和数据源的指针，必须先于它们结束
+    stop();
+}
+
+void PreAnnotationScheduler::stop()
+{
+    pool.clear();
+    pool.waitForDone();
+    ++generation;
+    pending.clear();
+    QMutexLocker locker(&shared->mutex);
+    shared->window.clear();
+}
+
+bool PreAnnotationScheduler::loadPlugin(const QString &path, QString *errorString)
+{
+    stop();
+    cache.clear();
+
+    auto newLoader = new QPluginLoader(path, this);
+    QObject *instance = newLoader->instance();
+    LabelerPlugin *newPlugin = qobject_cast<LabelerPlugin*>(instance);
+    if (!newPlugin) {
+        if (errorString) {
+            *errorString = instance ? QString("插件没有实现 %1 接口").arg(LabelerPlugin_iid)
+                                    : newLoader->errorString();
+        }
+        delete newLoader;
+        return false;
+    }
+
+    if (loader) {
+        loader->unload();
+        delete loader;
+    }
+    loader = newLoader;
+    plugin = newPlugin;
+    return true;
+}
+
+QString PreAnnotationScheduler::pluginName() const
+{
+    return plugin ? plugin->name() : QString();
+}
+
+void PreAnnotationScheduler::setSource(const ImageSource *newSource, const QStringList &newEntries)
+{
+    stop();
+    source = newSource;
+    entries = newEntries;
+    cache.clear();
+}
+
+void PreAnnotationScheduler::setLookahead(int count)
+{
+    lookahead = qMax(1, count);
+    cache.setMaxCost(qMax(MinCachedResults, CachedWindows * (lookahead + 1)));
+}
+
+void PreAnnotationScheduler::invalidate(const QStringList &changedEntries)
+{
+    if (changedEntries.isEmpty()) {
+        return;
+    }
+    for (const QString &entry : changedEntries) {
+        cache.remove(entry);
+    }
+    // 正在运行的批次可能读到了旧的图片。结果按批次返回，无法只丢弃其中几个条目，
+    // 因此整批作废；其余条目不再算作 pending，下次 prefetch 时重新提交。
+    ++generation;
+    pending.clear();
+}
+
+void PreAnnotationScheduler::prefetch(int index)
+{
+    if (!plugin || !source || index < 0 || index >= entries.size()) {
+        return;
+    }
+
+    const QStringList window = entries.mid(index, lookahead + 1);
+    {
+        QMutexLocker locker(&shared->mutex);
+        shared->window = QSet<QString>(window.begin(), window.end());
+    }
+
+    QStringList todo;
+    for (const QString &entry : window) {
+        if (!cache.contains(entry) && !pending.contains(entry)) {
+            todo << entry;
+        }
+    }
+    // 线程池按提交顺序执行，离当前图片近的批次先完成
+    const int batchSize = qMax(1, plugin->preferredBatchSize());
+    for (int i = 0; i < todo.size(); i += batchSize) {
+        submitBatch(todo.mid(i, batchSize));
+    }
+}
+
+bool PreAnnotationScheduler::result(const QString &entry, QList<AnnotationShape> *shapes) const
+{
+    const QList<AnnotationShape> *cached = cache.object(entry);
+    if (!cached) {
+        return false;
+    }
+    *shapes = *cached;
+    return true;
+}
+
+void PreAnnotationScheduler::submitBatch(const QStringList &batch)
+{
+    for (const QString &entry : batch) {
+        pending.insert(entry);
+    }
+
+    const int batchGeneration = generation;
+    LabelerPlugin *batchPlugin = plugin;
+    const ImageSource *batchSource = source;
+    std::shared_ptr<SharedState> state = shared;
+    pool.start([this, batch, batchGeneration, batchPlugin, batchSource, state]() {
+        // 排队期间标注员可能已经跳到别处，不在窗口内的条目不再推理
+        QStringList processed;
+        {
+            QMutexLocker locker(&state->mutex);
+            for (const QString &entry : batch) {
+                if (state->window.contains(entry)) {
+                    processed << entry;
+                }
+            }
+        }
+
+        QList<QList<AnnotationShape>> results;
+        if (!processed.isEmpty()) {
+            QList<QImage> images;
+            images.reserve(processed.size());
+            for (const QString &entry : processed) {
+                images << batchSource->readImage(entry);
+            }
+            results = batchPlugin->annotate(images);
+        }
+
+        QMetaObject::invokeMethod(this, [this, batchGeneration, batch, processed, results]() {
+            finishBatch(batchGeneration, batch, processed, results);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void PreAnnotationScheduler::finishBatch(int batchGeneration, const QStringList &batch, const QStringList &processed,
+                                         const QList<QList<AnnotationShape>> &results)
+{
+    if (batchGeneration != generation) {
+        return;
+    }
+    // 被跳过的条目没有结果，之后重新进入窗口时会再次提交
+    for (const QString &entry : batch) {
+        pending.remove(entry);
+    }
+    for (int i = 0; i < processed.size(); ++i) {
+        cache.insert(processed[i], new QList<AnnotationShape>(results.value(i)));
+        emit resultReady(processed[i]);
+    }
+}
@@ -0,0 +1,74 @@
+/* *************************************************************** */
+/* preannotationscheduler.h                    */
+/* *************************************************************** */
+#ifndef PREANNOTATIONSCHEDULER_H
+#define PREANNOTATIONSCHEDULER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QCache>
+#include <QSet>
+#include <QStringList>
+#include <memory>
+#include "annotationfile.h"
+
+class ImageSource;
+class LabelerPlugin;
+class QPluginLoader;
+
+// 在标注员前面提前运行预标注插件：当前图片之后的若干张按批提交到一个
+// 线程数有限的线程池，结果按条目名缓存，打开图片时直接取用。
+class PreAnnotationScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PreAnnotationScheduler(QObject *parent = nullptr);
+    ~PreAnnotationScheduler();
+
+    // 加载插件，替换之前的插件并清空缓存
+    bool loadPlugin(const QString& path, QString* errorString = nullptr);
+    bool hasPlugin() const { return plugin != nullptr; }
+    QString pluginName() const;
+
+    // 切换数据集。会等待仍在读取旧数据源的任务结束，传入 nullptr 表示停止。
+    void setSource(const ImageSource* source, const QStringList& entries);
+    // 数据集中的条目有增删时更新列表，已有的缓存保留
+    void setEntries(const QStringList& newEntries) { entries = newEntries; }
+    // 条目的图片被修改、删除或替换：丢弃它们的缓存结果，正在进行的批次的结果也一并丢弃。
+    // 之后需要重新调用 prefetch。
+    void invalidate(const QStringList& changedEntries);
+    void setLookahead(int count);
+
+    // 安排 entries[index] 及其后 lookahead 张图片的推理；窗口之外还在排队的条目会被跳过
+    void prefetch(int index);
+    // 条目的缓存结果，尚未完成时返回 false
+    bool result(const QString& entry, QList<AnnotationShape>* shapes) const;
+
+signals:
+    void resultReady(const QString& entry);
+
+private:
+    struct SharedState;
+
+    void stop();
+    void submitBatch(const QStringList& batch);
+    void finishBatch(int generation, const QStringList& batch, const QStringList& processed,
+                     const QList<QList<AnnotationShape>>& results);
+
+    QPluginLoader* loader = nullptr;
+    LabelerPlugin* plugin = nullptr;
+    QThreadPool pool;
+    const ImageSource* source = nullptr;
+    QStringList entries;
+    int lookahead = 8;
+    int generation = 0;
+
+    // 工作线程在开始处理一批之前检查其中的条目是否仍在预取窗口内
+    std::shared_ptr<SharedState> shared;
+    // 最近的结果，超过容量时淘汰最久未用的条目，长时间标注时内存不会一直增长
+    QCache<QString, QList<AnnotationShape>> cache;
+    QSet<QString> pending;
+};
+
+#endif // PREANNOTATIONSCHEDULER_H
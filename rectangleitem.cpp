@@ -1,16 +1,21 @@
 #include "rectangleitem.h"
+#include "canvasscene.h"
 
 RectangleItem::RectangleItem(const QRectF &rect, QGraphicsItem *parent)
     : QGraphicsRectItem(rect, parent)
 {
     setPen(QPen(Qt::red, 2));
     setBrush(QColor(255, 0, 0, 70)); // Semi-transparent red fill
+    setAcceptHoverEvents(true); // 悬停的矩形实时绘制，不从缓存图层取
 }
 
 void RectangleItem::setLabel(const QString &label)
 {
     itemLabel = label;
     update();
+    if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+        canvas->annotationChanged(this);
+    }
 }
 
 QString RectangleItem::getLabel() const
@@ -20,6 +25,12 @@ QString RectangleItem::getLabel() const
 
 void RectangleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
+    // 未选中的标注已经画在场景的缓存图层里
+    auto canvas = qobject_cast<CanvasScene*>(scene());
+    if (canvas && canvas->isDrawnFromCache(this)) {
+        return;
+    }
+
     QGraphicsRectItem::paint(painter, option, widget);
 
     painter->setPen(Qt::black);
@@ -27,3 +38,34 @@ void RectangleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
     painter->setBackgroundMode(Qt::OpaqueMode);
     painter->drawText(boundingRect().topLeft() + QPointF(5, 20), itemLabel);
 }
+
+void RectangleItem::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
+{
+    if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+        canvas->setHoveredAnnotation(this);
+    }
+    QGraphicsRectItem::hoverEnterEvent(event);
+}
+
+void RectangleItem::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
+{
+    if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+        canvas->setHoveredAnnotation(nullptr);
+    }
+    QGraphicsRectItem::hoverLeaveEvent(event);
+}
+
+QVariant RectangleItem::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if (auto canvas = qobject_cast<CanvasScene*>(scene())) {
+        if (change == ItemSceneChange) {
+            canvas->annotationRemoved(this);
+        } else if (change == ItemSceneHasChanged || change == ItemSelectedHasChanged
+                   || change == ItemFlagsHaveChanged || change == ItemVisibleHasChanged) {
+            canvas->annotationChanged(this);
+        } else if (change == ItemPositionHasChanged) {
+            canvas->annotationChanged(this, true);
+        }
+    }
+    return QGraphicsRectItem::itemChange(change, value);
+}
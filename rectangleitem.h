@@ -14,6 +14,11 @@ public:
 
 protected:
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+    void hoverEnterEvent(QGraphicsSceneHoverEvent *event) override;
+    void hoverLeaveEvent(QGraphicsSceneHoverEvent *event) override;
+
+    // 通知 CanvasScene 更新缓存图层
+    QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
 
 private:
     QString itemLabel;
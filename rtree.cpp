@@ -0,0 +1,117 @@
+/* *************************************************************** */
+/* rtree.cpp                               */
+/* *************************************************************** */
+#include "rtree.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// QRectF::intersects 对宽或高为零的矩形总是返回 false，这里需要包含退化的包围盒
+bool overlaps(const QRectF &a, const QRectF &b)
+{
+    return a.left() <= b.right() && b.left() <= a.right()
+        && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+} // namespace
+
+BoxRTree::BoxRTree(const QVector<QRectF> &boxes, int nodeCapacity)
+    : boxes(boxes)
+    , capacity(qMax(2, nodeCapacity))
+{
+    if (boxes.isEmpty()) {
+        return;
+    }
+
+    QVector<int> items(boxes.size());
+    for (int i = 0; i < items.size(); ++i) {
+        items[i] = i;
+    }
+
+    QVector<int> level = packLevel(items, true);
+    while (level.size() > 1) {
+        level = packLevel(level, false);
+    }
+    root = level.first();
+}
+
+QVector<int> BoxRTree::packLevel(QVector<int> items, bool leafLevel)
+{
+    auto boundsOf = [this, leafLevel](int item) -> const QRectF & {
+        return leafLevel ? boxes[item] : nodes[item].bounds;
+    };
+
+    // STR：先按中心 x 排序切成 S 个竖条，每个竖条内再按中心 y 排序后按容量打包
+    const int nodeCount = (items.size() + capacity - 1) / capacity;
+    const int sliceCount = int(std::ceil(std::sqrt(double(nodeCount))));
+    const int sliceSize = sliceCount * capacity;
+
+    std::sort(items.begin(), items.end(), [&](int a, int b) {
+        return boundsOf(a).center().x() < boundsOf(b).center().x();
+    });
+    for (int start = 0; start < items.size(); start += sliceSize) {
+        auto sliceEnd = items.begin() + qMin(start + sliceSize, int(items.size()));
+        std::sort(items.begin() + start, sliceEnd, [&](int a, int b) {
+            return boundsOf(a).center().y() < boundsOf(b).center().y();
+        });
+    }
+
+    QVector<int> parents;
+    parents.reserve(nodeCount);
+    for (int start = 0; start < items.size(); start += capacity) {
+        const int count = qMin(capacity, int(items.size()) - start);
+        Node node;
+        node.leaf = leafLevel;
+        node.count = count;
+        node.bounds = boundsOf(items[start]);
+
+        if (leafLevel) {
+            node.first = entries.size();
+            for (int i = 0; i < count; ++i) {
+                entries.append(items[start + i]);
+                node.bounds |= boxes[items[start + i]];
+            }
+        } else {
+            // 子节点需要在 nodes 中连续存放，因此复制一份到末尾
+            node.first = nodes.size();
+            for (int i = 0; i < count; ++i) {
+                Node child = nodes[items[start + i]];
+                node.bounds |= child.bounds;
+                nodes.append(child);
+            }
+        }
+        parents.append(nodes.size());
+        nodes.append(node);
+    }
+    return parents;
+}
+
+QVector<int> BoxRTree::query(const QRectF &rect) const
+{
+    QVector<int> result;
+    if (root < 0) {
+        return result;
+    }
+
+    QVector<int> stack;
+    stack.append(root);
+    while (!stack.isEmpty()) {
+        const Node &node = nodes[stack.takeLast()];
+        if (!overlaps(node.bounds, rect)) {
+            continue;
+        }
+        for (int i = 0; i < node.count; ++i) {
+            if (node.leaf) {
+                int entry = entries[node.first + i];
+                if (overlaps(boxes[entry], rect)) {
+                    result.append(entry);
+                }
+            } else {
+                stack.append(node.first + i);
+            }
+        }
+    }
+    return result;
+}
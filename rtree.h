@@ -0,0 +1,40 @@
+/* *************************************************************** */
+/* rtree.h                                 */
+/* *************************************************************** */
+#ifndef RTREE_H
+#define RTREE_H
+
+#include <QRectF>
+#include <QVector>
+
+// 静态R树：一次性用 STR (Sort-Tile-Recursive) 方法批量构建，只支持区域查询。
+// 用于在单张图片的数千个形状中快速找到包围盒相交的候选对。
+class BoxRTree
+{
+public:
+    explicit BoxRTree(const QVector<QRectF>& boxes, int nodeCapacity = 16);
+
+    // 返回包围盒与 rect 相交（含边界接触）的所有条目序号
+    QVector<int> query(const QRectF& rect) const;
+
+    int size() const { return boxes.size(); }
+
+private:
+    struct Node
+    {
+        QRectF bounds;
+        int first = 0;  // 叶子节点：entries 中的起始位置；内部节点：nodes 中第一个子节点
+        int count = 0;
+        bool leaf = true;
+    };
+
+    QVector<int> packLevel(QVector<int> items, bool leafLevel);
+
+    QVector<QRectF> boxes;
+    QVector<int> entries;
+    QVector<Node> nodes;
+    int capacity;
+    int root = -1;
+};
+
+#endif // RTREE_H
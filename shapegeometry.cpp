@@ -0,0 +1,153 @@
+/* *************************************************************** */
+/* shapegeometry.cpp                       */
+/* *************************************************************** */
+#include "shapegeometry.h"
+
+#include <QtMath>
+#include <QPainterPath>
+
+namespace {
+
+qreal cross(const QPointF &o, const QPointF &a, const QPointF &b)
+{
+    return (a.x() - o.x()) * (b.y() - o.y()) - (a.y() - o.y()) * (b.x() - o.x());
+}
+
+int orientation(const QPointF &o, const QPointF &a, const QPointF &b)
+{
+    qreal value = cross(o, a, b);
+    if (qFuzzyIsNull(value)) {
+        return 0;
+    }
+    return value > 0 ? 1 : -1;
+}
+
+// 已知 p, q, r 共线时，判断 q 是否落在线段 pr 上
+bool onSegment(const QPointF &p, const QPointF &q, const QPointF &r)
+{
+    return q.x() <= qMax(p.x(), r.x()) && q.x() >= qMin(p.x(), r.x())
+        && q.y() <= qMax(p.y(), r.y()) && q.y() >= qMin(p.y(), r.y());
+}
+
+// 四个顶点、按顺时针或逆时针构成轴对齐矩形时返回 true
+bool isAxisAlignedRectangle(const QPolygonF &polygon)
+{
+    if (polygon.size() != 4) {
+        return false;
+    }
+    return (polygon[0].y() == polygon[1].y() && polygon[1].x() == polygon[2].x()
+            && polygon[2].y() == polygon[3].y() && polygon[3].x() == polygon[0].x())
+        || (polygon[0].x() == polygon[1].x() && polygon[1].y() == polygon[2].y()
+            && polygon[2].x() == polygon[3].x() && polygon[3].y() == polygon[0].y());
+}
+
+} // namespace
+
+qreal ShapeGeometry::polygonArea(const QPolygonF &polygon)
+{
+    const int n = polygon.size();
+    if (n < 3) {
+        return 0.0;
+    }
+    qreal sum = 0.0;
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        sum += polygon[j].x() * polygon[i].y() - polygon[i].x() * polygon[j].y();
+    }
+    return qAbs(sum) * 0.5;
+}
+
+bool ShapeGeometry::segmentsIntersect(const QPointF &a1, const QPointF &a2, const QPointF &b1, const QPointF &b2)
+{
+    int o1 = orientation(a1, a2, b1);
+    int o2 = orientation(a1, a2, b2);
+    int o3 = orientation(b1, b2, a1);
+    int o4 = orientation(b1, b2, a2);
+
+    if (o1 != o2 && o3 != o4) {
+        return true;
+    }
+    if (o1 == 0 && onSegment(a1, b1, a2)) return true;
+    if (o2 == 0 && onSegment(a1, b2, a2)) return true;
+    if (o3 == 0 && onSegment(b1, a1, b2)) return true;
+    if (o4 == 0 && onSegment(b1, a2, b2)) return true;
+    return false;
+}
+
+bool ShapeGeometry::isSelfIntersecting(const QPolygonF &polygon)
+{
+    QPolygonF points = polygon;
+    if (points.size() > 1 && points.first() == points.last()) {
+        points.removeLast();
+    }
+    const int n = points.size();
+    if (n < 4) {
+        return false;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        const QPointF &a1 = points[i];
+        const QPointF &a2 = points[(i + 1) % n];
+        // 相邻的边共享端点，跳过；第 0 条边和最后一条边同样相邻
+        for (int j = i + 2; j < n; ++j) {
+            if (i == 0 && j == n - 1) {
+                continue;
+            }
+            if (segmentsIntersect(a1, a2, points[j], points[(j + 1) % n])) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+qreal ShapeGeometry::intersectionArea(const QPolygonF &a, const QPolygonF &b)
+{
+    QPainterPath pathA;
+    pathA.addPolygon(a);
+    pathA.closeSubpath();
+    QPainterPath pathB;
+    pathB.addPolygon(b);
+    pathB.closeSubpath();
+
+    // 两个简单多边形的交集可能由多个不相连的部分组成，分别求面积后相加
+    qreal area = 0.0;
+    const QList<QPolygonF> parts = pathA.intersected(pathB).toSubpathPolygons();
+    for (const QPolygonF &part : parts) {
+        area += polygonArea(part);
+    }
+    return area;
+}
+
+qreal ShapeGeometry::intersectionOverUnion(const QPolygonF &a, const QPolygonF &b)
+{
+    qreal intersection = 0.0;
+    qreal areaA = 0.0;
+    qreal areaB = 0.0;
+    if (isAxisAlignedRectangle(a) && isAxisAlignedRectangle(b)) {
+        QRectF rectA = a.boundingRect();
+        QRectF rectB = b.boundingRect();
+        QRectF overlap = rectA & rectB;
+        intersection = overlap.width() * overlap.height();
+        areaA = rectA.width() * rectA.height();
+        areaB = rectB.width() * rectB.height();
+    } else {
+        if (!a.boundingRect().intersects(b.boundingRect())) {
+            return 0.0;
+        }
+        intersection = intersectionArea(a, b);
+        areaA = polygonArea(a);
+        areaB = polygonArea(b);
+    }
+
+    qreal unionArea = areaA + areaB - intersection;
+    return unionArea > 0.0 ? intersection / unionArea : 0.0;
+}
+
+QPolygonF ShapeGeometry::rectangleToPolygon(const QRectF &rect)
+{
+    QRectF normalized = rect.normalized();
+    QPolygonF polygon;
+    polygon << normalized.topLeft() << normalized.topRight()
+            << normalized.bottomRight() << normalized.bottomLeft();
+    return polygon;
+}
@@ -0,0 +1,32 @@
+/* *************************************************************** */
+/* shapegeometry.h                         */
+/* *************************************************************** */
+#ifndef SHAPEGEOMETRY_H
+#define SHAPEGEOMETRY_H
+
+#include <QPolygonF>
+#include <QLineF>
+
+// 标注形状的几何工具函数，只依赖值类型，可在工作线程中调用
+namespace ShapeGeometry
+{
+    // 多边形面积（鞋带公式，取绝对值）。多边形视为首尾相连。
+    qreal polygonArea(const QPolygonF& polygon);
+
+    // 两条线段是否相交（包含端点接触和共线重叠）
+    bool segmentsIntersect(const QPointF& a1, const QPointF& a2, const QPointF& b1, const QPointF& b2);
+
+    // 多边形的非相邻边之间是否存在交点
+    bool isSelfIntersecting(const QPolygonF& polygon);
+
+    // 两个多边形相交部分的精确面积（基于 QPainterPath 的布尔运算）
+    qreal intersectionArea(const QPolygonF& a, const QPolygonF& b);
+
+    // 交并比。两个都是轴对齐矩形时直接按矩形计算。
+    qreal intersectionOverUnion(const QPolygonF& a, const QPolygonF& b);
+
+    // 矩形转换成四个顶点的多边形，便于和多边形统一处理
+    QPolygonF rectangleToPolygon(const QRectF& rect);
+}
+
+#endif // SHAPEGEOMETRY_H
@@ -0,0 +1,263 @@
+/* *************************************************************** */
+/* templatetracker.cpp                       */
+/* *************************************************************** */
+#include "templatetracker.h"
+
+#include <QImage>
+#include <cmath>
+
+namespace {
+
+const int MinLevelSize = 16;      // 金字塔最小一级的短边
+const int MinTemplateSize = 8;    // 最粗一级模板的最小边长
+const int MaxTemplateSize = 96;   // 模板的最大边长，更大的形状只取中心部分
+const int RefineRadius = 2;       // 逐级细化时的搜索半径
+const int Lanes = 8;
+
+struct Match
+{
+    bool found = false;
+    QPoint offset;
+    QPointF subpixel;
+    double score = -1;
+};
+
+GrayImage halve(const GrayImage &source)
+{
+    GrayImage result;
+    result.width = source.width / 2;
+    result.height = source.height / 2;
+    result.pixels.resize(qsizetype(result.width) * result.height);
+    float *out = result.pixels.data();
+    for (int y = 0; y < result.height; ++y) {
+        const float *row0 = source.row(2 * y);
+        const float *row1 = source.row(2 * y + 1);
+        for (int x = 0; x < result.width; ++x) {
+            out[x] = 0.25f * (row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1]);
+        }
+        out += result.width;
+    }
+    return result;
+}
+
+// 模板一行与目标一行的互相关、和、平方和。
+// 使用 Lanes 路独立的部分和，不需要 -ffast-math 编译器也能把内层循环向量化。
+void accumulateRow(const float *templ, const float *target, int count,
+                   double &cross, double &sum, double &sumSquares)
+{
+    float c[Lanes] = {};
+    float s[Lanes] = {};
+    float q[Lanes] = {};
+    int i = 0;
+    for (; i + Lanes <= count; i += Lanes) {
+        for (int k = 0; k < Lanes; ++k) {
+            const float v = target[i + k];
+            c[k] += templ[i + k] * v;
+            s[k] += v;
+            q[k] += v * v;
+        }
+    }
+    for (; i < count; ++i) {
+        const float v = target[i];
+        c[0] += templ[i] * v;
+        s[0] += v;
+        q[0] += v * v;
+    }
+    for (int k = 0; k < Lanes; ++k) {
+        cross += c[k];
+        sum += s[k];
+        sumSquares += q[k];
+    }
+}
+
+// 抛物线插值，返回 -0.5..0.5 的亚像素修正
+qreal parabolaPeak(double left, double center, double right)
+{
+    const double denominator = left - 2 * center + right;
+    if (denominator >= 0) {
+        return 0;
+    }
+    return qBound(-0.5, 0.5 * (left - right) / denominator, 0.5);
+}
+
+// 在 target 中以 center 为中心、radius 为半径搜索 source 里 box 区域的最佳匹配
+Match matchTemplate(const GrayImage &source, const GrayImage &target, QRect box, const QPoint &center, int radius)
+{
+    box &= QRect(0, 0, source.width, source.height);
+    if (box.width() < 2 || box.height() < 2) {
+        return {};
+    }
+
+    const int templateWidth = box.width();
+    const int templateHeight = box.height();
+    const int count = templateWidth * templateHeight;
+
+    // 去均值后的模板。Σt = 0，因此与目标窗口的互相关无需再减去窗口均值。
+    QVector<float> templ(count);
+    double mean = 0;
+    for (int y = 0; y < templateHeight; ++y) {
+        const float *in = source.row(box.y() + y) + box.x();
+        float *out = templ.data() + qsizetype(y) * templateWidth;
+        for (int x = 0; x < templateWidth; ++x) {
+            out[x] = in[x];
+            mean += in[x];
+        }
+    }
+    mean /= count;
+    double templateEnergy = 0;
+    for (float &value : templ) {
+        value -= float(mean);
+        templateEnergy += double(value) * value;
+    }
+    // 纹理过于平坦时没有可以锁定的内容
+    if (templateEnergy < 1e-3 * count) {
+        return {};
+    }
+
+    const int side = 2 * radius + 1;
+    QVector<double> scores(side * side, -2.0);
+    Match best;
+    for (int dy = -radius; dy <= radius; ++dy) {
+        const int top = box.y() + center.y() + dy;
+        if (top < 0 || top + templateHeight > target.height) {
+            continue;
+        }
+        for (int dx = -radius; dx <= radius; ++dx) {
+            const int left = box.x() + center.x() + dx;
+            if (left < 0 || left + templateWidth > target.width) {
+                continue;
+            }
+
+            double cross = 0;
+            double sum = 0;
+            double sumSquares = 0;
+            for (int y = 0; y < templateHeight; ++y) {
+                accumulateRow(templ.constData() + qsizetype(y) * templateWidth, target.row(top + y) + left,
+                              templateWidth, cross, sum, sumSquares);
+            }
+            const double variance = sumSquares - sum * sum / count;
+            if (variance <= 1e-6) {
+                continue;
+            }
+
+            const double score = cross / std::sqrt(templateEnergy * variance);
+            scores[(dy + radius) * side + dx + radius] = score;
+            if (!best.found || score > best.score) {
+                best.found = true;
+                best.score = score;
+                best.offset = center + QPoint(dx, dy);
+            }
+        }
+    }
+    if (!best.found) {
+        return best;
+    }
+
+    const int bx = best.offset.x() - center.x() + radius;
+    const int by = best.offset.y() - center.y() + radius;
+    auto scoreAt = [&](int x, int y) {
+        return (x >= 0 && y >= 0 && x < side && y < side) ? scores[y * side + x] : -2.0;
+    };
+    const double middle = best.score;
+    if (scoreAt(bx - 1, by) > -2 && scoreAt(bx + 1, by) > -2) {
+        best.subpixel.setX(parabolaPeak(scoreAt(bx - 1, by), middle, scoreAt(bx + 1, by)));
+    }
+    if (scoreAt(bx, by - 1) > -2 && scoreAt(bx, by + 1) > -2) {
+        best.subpixel.setY(parabolaPeak(scoreAt(bx, by - 1), middle, scoreAt(bx, by + 1)));
+    }
+    return best;
+}
+
+} // namespace
+
+TrackingFrame TrackingFrame::build(const QImage &image, int maxLevels)
+{
+    TrackingFrame frame;
+    const QImage gray = image.convertToFormat(QImage::Format_Grayscale8);
+    if (gray.isNull()) {
+        return frame;
+    }
+
+    GrayImage base;
+    base.width = gray.width();
+    base.height = gray.height();
+    base.pixels.resize(qsizetype(base.width) * base.height);
+    float *out = base.pixels.data();
+    for (int y = 0; y < base.height; ++y) {
+        const uchar *in = gray.constScanLine(y);
+        for (int x = 0; x < base.width; ++x) {
+            out[x] = in[x];
+        }
+        out += base.width;
+    }
+    frame.levels.append(base);
+
+    while (frame.levels.size() < maxLevels) {
+        const GrayImage &last = frame.levels.last();
+        if (last.width / 2 < MinLevelSize || last.height / 2 < MinLevelSize) {
+            break;
+        }
+        frame.levels.append(halve(last));
+    }
+    return frame;
+}
+
+QPointF TemplateTracker::locate(const TrackingFrame &previous, const TrackingFrame &next,
+                                const QRect &box, int searchRadius, double *score)
+{
+    if (score) {
+        *score = 0;
+    }
+    const int levelCount = qMin(previous.levels.size(), next.levels.size());
+    if (levelCount == 0 || box.width() < MinTemplateSize || box.height() < MinTemplateSize) {
+        return {};
+    }
+
+    // 最粗一级：模板和搜索半径都还足够大。之后逐级细化到原始分辨率。
+    const int shortSide = qMin(box.width(), box.height());
+    int coarse = 0;
+    while (coarse + 1 < levelCount && (shortSide >> (coarse + 1)) >= MinTemplateSize
+           && (searchRadius >> (coarse + 1)) >= RefineRadius) {
+        ++coarse;
+    }
+
+    QPoint offset;
+    QPointF subpixel;
+    double levelScore = 0;
+    int radius = qMax(RefineRadius, (searchRadius + (1 << coarse) - 1) >> coarse);
+    for (int level = coarse; level >= 0; --level) {
+        if (level != coarse) {
+            offset *= 2;
+            radius = RefineRadius;
+        }
+        // 大形状在细的级别上只取中心部分作为模板，每级的计算量有上限
+        QRect levelBox(box.x() >> level, box.y() >> level, box.width() >> level, box.height() >> level);
+        const int width = qMin(levelBox.width(), MaxTemplateSize);
+        const int height = qMin(levelBox.height(), MaxTemplateSize);
+        levelBox = QRect(levelBox.x() + (levelBox.width() - width) / 2, levelBox.y() + (levelBox.height() - height) / 2,
+                         width, height);
+
+        const Match match = matchTemplate(previous.levels[level], next.levels[level], levelBox, offset, radius);
+        if (!match.found) {
+            return {};
+        }
+        offset = match.offset;
+        subpixel = match.subpixel;
+        levelScore = match.score;
+    }
+
+    if (score) {
+        *score = levelScore;
+    }
+    return QPointF(offset) + subpixel;
+}
+
+TrackedShape TemplateTracker::track(const TrackingFrame &previous, const TrackingFrame &next,
+                                    const AnnotationShape &shape, int searchRadius)
+{
+    TrackedShape result;
+    result.shape = shape;
+    result.offset = locate(previous, next, shape.points.boundingRect().toAlignedRect(), searchRadius, &result.score);
+    result.shape.points.translate(result.offset);
+    return result;
+}
@@ -0,0 +1,55 @@
+/* *************************************************************** */
+/* templatetracker.h                       */
+/* *************************************************************** */
+#ifndef TEMPLATETRACKER_H
+#define TEMPLATETRACKER_H
+
+#include <QVector>
+#include <QList>
+#include <QRect>
+#include <QPointF>
+#include "annotationfile.h"
+
+class QImage;
+
+// 单通道浮点灰度图，按行连续存储
+struct GrayImage
+{
+    int width = 0;
+    int height = 0;
+    QVector<float> pixels;
+
+    const float *row(int y) const { return pixels.constData() + qsizetype(y) * width; }
+};
+
+// 一帧的灰度金字塔，levels[0] 为原始分辨率，之后每级边长减半
+struct TrackingFrame
+{
+    QList<GrayImage> levels;
+
+    static TrackingFrame build(const QImage& image, int maxLevels = 5);
+};
+
+struct TrackedShape
+{
+    AnnotationShape shape; // 已平移到新位置
+    QPointF offset;
+    double score = 0;      // 最终一级的归一化互相关，-1..1；跟踪失败时为 0
+};
+
+// 帧间模板跟踪：以形状外接矩形在上一帧中的内容为模板，
+// 在下一帧中由粗到细做归一化互相关（NCC）搜索，得到形状的平移量。
+// 只读取传入的金字塔，可以在工作线程中对每个形状并行调用。
+class TemplateTracker
+{
+public:
+    // searchRadius 为原始分辨率下的最大搜索位移（像素）
+    static TrackedShape track(const TrackingFrame& previous, const TrackingFrame& next,
+                              const AnnotationShape& shape, int searchRadius = 48);
+
+    // 在 next 中搜索 previous 里 box 区域的最佳匹配位置，返回相对 box 的位移
+    static QPointF locate(const TrackingFrame& previous, const TrackingFrame& next,
+                          const QRect& box, int searchRadius, double *score = nullptr);
+};
+
+#endif // TEMPLATETRACKER_H